@@ -3,6 +3,8 @@
 
 #include "LooterGameModeBase.h"
 #include "PlayerCharacter.h"
+#include "ProcGen/ProcMapNetComponent.h"
+#include "GameFramework/PlayerController.h"
 
 ALooterGameModeBase::ALooterGameModeBase()
 {
@@ -13,3 +15,15 @@ ALooterGameModeBase::ALooterGameModeBase()
 	// HUDClass = AMyHUD::StaticClass();
 	// PlayerControllerClass = AMyPlayerController::StaticClass();
 }
+
+void ALooterGameModeBase::PostLogin(APlayerController* NewPlayer)
+{
+	Super::PostLogin(NewPlayer);
+
+	// Lets the player's client check its locally generated maps against ours
+	if (NewPlayer && !NewPlayer->FindComponentByClass<UProcMapNetComponent>())
+	{
+		UProcMapNetComponent* MapNet = NewObject<UProcMapNetComponent>(NewPlayer, TEXT("ProcMapNet"));
+		MapNet->RegisterComponent();
+	}
+}
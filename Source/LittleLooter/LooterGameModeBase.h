@@ -16,4 +16,6 @@ class LITTLELOOTER_API ALooterGameModeBase : public AGameModeBase
 	
 public:
 	ALooterGameModeBase();
+
+	virtual void PostLogin(APlayerController* NewPlayer) override;
 };
@@ -0,0 +1,22 @@
+#include "CellBitGrid.h"
+
+void FCellBitGrid::Dilate4(const FCellBitGrid& In, FCellBitGrid& Out)
+{
+	Out.Init(In.Width, In.Height);
+	if (In.WordsPerRow == 0) return;
+
+	const int32 Last = In.WordsPerRow - 1;
+	const uint64 TailMask = In.LastWordMask();
+	for (int32 y = 0; y < In.Height; ++y)
+	{
+		const uint64* Row = In.GetRow(y);
+		const uint64* Below = y > 0 ? In.GetRow(y - 1) : nullptr;
+		const uint64* Above = y + 1 < In.Height ? In.GetRow(y + 1) : nullptr;
+		uint64* Dst = Out.GetRow(y);
+
+		// Vertical neighbors are plain word ORs across rows; these loops vectorize
+		for (int32 w = 0; w <= Last; ++w) Dst[w] = (Below ? Below[w] : 0) | (Above ? Above[w] : 0);
+		for (int32 w = 0; w <= Last; ++w) Dst[w] |= In.EastOf(Row, w) | In.WestOf(Row, w);
+		Dst[Last] &= TailMask;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * One bit per cell, 64 cells per word, rows padded to whole words.
+ * Neighbor tests become word-wide shifts and ORs, so morphology passes (walls, open edges)
+ * touch W*H/64 words instead of W*H cells. Bits past Width in a row's last word are always zero.
+ */
+struct FCellBitGrid
+{
+	/** Sizes and clears the grid, keeping the old allocation. */
+	void Init(int32 InWidth, int32 InHeight)
+	{
+		Width = FMath::Max(InWidth, 0);
+		Height = FMath::Max(InHeight, 0);
+		WordsPerRow = FMath::DivideAndRoundUp(Width, 64);
+		Words.SetNumUninitialized(WordsPerRow * Height, EAllowShrinking::No);
+		if (Words.Num() > 0) FMemory::Memzero(Words.GetData(), Words.Num() * sizeof(uint64));
+	}
+
+	FORCEINLINE bool IsInBounds(int32 X, int32 Y) const { return X >= 0 && Y >= 0 && X < Width && Y < Height; }
+	FORCEINLINE void Set(int32 X, int32 Y) { Words[Y * WordsPerRow + (X >> 6)] |= (uint64(1) << (X & 63)); }
+	FORCEINLINE bool Test(int32 X, int32 Y) const
+	{
+		return IsInBounds(X, Y) && (Words[Y * WordsPerRow + (X >> 6)] & (uint64(1) << (X & 63))) != 0;
+	}
+
+	FORCEINLINE uint64* GetRow(int32 Y) { return Words.GetData() + Y * WordsPerRow; }
+	FORCEINLINE const uint64* GetRow(int32 Y) const { return Words.GetData() + Y * WordsPerRow; }
+
+	/** Mask of valid cells in a row's last word. */
+	FORCEINLINE uint64 LastWordMask() const
+	{
+		const int32 Tail = Width & 63;
+		return Tail == 0 ? ~uint64(0) : ((uint64(1) << Tail) - 1);
+	}
+
+	/** Word W of row Y shifted so bit x holds cell (x+1, y). */
+	FORCEINLINE uint64 EastOf(const uint64* Row, int32 W) const
+	{
+		return (Row[W] >> 1) | (W + 1 < WordsPerRow ? (Row[W + 1] << 63) : 0);
+	}
+
+	/** Word W of row Y shifted so bit x holds cell (x-1, y). */
+	FORCEINLINE uint64 WestOf(const uint64* Row, int32 W) const
+	{
+		return (Row[W] << 1) | (W > 0 ? (Row[W - 1] >> 63) : 0);
+	}
+
+	/** Calls Fn(X, Y) for every set bit in row-major order. */
+	template <typename FuncType>
+	void ForEachSetBit(FuncType&& Fn) const
+	{
+		for (int32 y = 0; y < Height; ++y)
+		{
+			const uint64* Row = GetRow(y);
+			for (int32 w = 0; w < WordsPerRow; ++w)
+			{
+				uint64 Bits = Row[w];
+				while (Bits)
+				{
+					const int32 Bit = (int32)FMath::CountTrailingZeros64(Bits);
+					Fn((w << 6) + Bit, y);
+					Bits &= Bits - 1;
+				}
+			}
+		}
+	}
+
+	/** Out = cells that have at least one 4-neighbor set in In. Out is resized to match. */
+	static void Dilate4(const FCellBitGrid& In, FCellBitGrid& Out);
+
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 WordsPerRow = 0;
+	TArray<uint64> Words;
+};
@@ -0,0 +1,63 @@
+#include "ChunkedCellGrid.h"
+
+void FChunkedCellGrid::Init(int32 InWidth, int32 InHeight, bool bWithRoomIds, bool bWithFlags)
+{
+	Reset();
+	Width = FMath::Max(InWidth, 0);
+	Height = FMath::Max(InHeight, 0);
+	ChunksX = FMath::DivideAndRoundUp(Width, ChunkSize);
+	ChunksY = FMath::DivideAndRoundUp(Height, ChunkSize);
+	bRoomIds = bWithRoomIds;
+	bFlags = bWithFlags;
+
+	Directory.SetNumUninitialized(ChunksX * ChunksY, EAllowShrinking::No);
+	for (int32& Slot : Directory) Slot = INDEX_NONE;
+}
+
+void FChunkedCellGrid::Reset()
+{
+	Width = Height = ChunksX = ChunksY = 0;
+	Directory.Reset();
+	ChunkCoords.Reset();
+	Types.Reset();
+	RoomIds.Reset();
+	Flags.Reset();
+}
+
+int32 FChunkedCellGrid::FindOrAddChunk(int32 X, int32 Y)
+{
+	if (!IsInBounds(X, Y)) return INDEX_NONE;
+
+	int32& Slot = Directory[(Y >> ChunkShift) * ChunksX + (X >> ChunkShift)];
+	if (Slot != INDEX_NONE) return Slot;
+
+	Slot = ChunkCoords.Add(FIntPoint(X >> ChunkShift, Y >> ChunkShift));
+	Types.AddZeroed(CellsPerChunk);
+	if (bRoomIds)
+	{
+		const int32 First = RoomIds.AddUninitialized(CellsPerChunk);
+		for (int32 i = 0; i < CellsPerChunk; ++i) RoomIds[First + i] = INDEX_NONE;
+	}
+	if (bFlags) Flags.AddZeroed(CellsPerChunk);
+	return Slot;
+}
+
+SIZE_T FChunkedCellGrid::GetBytesPerChunk() const
+{
+	SIZE_T Bytes = CellsPerChunk * sizeof(uint8) + sizeof(FIntPoint);
+	if (bRoomIds) Bytes += CellsPerChunk * sizeof(int32);
+	if (bFlags) Bytes += CellsPerChunk * sizeof(uint8);
+	return Bytes;
+}
+
+SIZE_T FChunkedCellGrid::GetAllocatedSize() const
+{
+	return Directory.GetAllocatedSize() + ChunkCoords.GetAllocatedSize()
+		+ Types.GetAllocatedSize() + RoomIds.GetAllocatedSize() + Flags.GetAllocatedSize();
+}
+
+void FChunkedCellGrid::Serialize(FArchive& Ar)
+{
+	Ar << Width << Height << ChunksX << ChunksY << bRoomIds << bFlags;
+	Ar << Directory << ChunkCoords << Types << RoomIds << Flags;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Sparse cell storage for very large, mostly empty maps.
+ * The map is split into 32x32 chunks that are only allocated when a non-default value is written.
+ * A dense directory maps chunk coordinates to chunk slots, and cells inside a chunk are laid out
+ * in Morton (Z) order so 2D neighbors stay close in memory.
+ * Planes mirror FCellGrid but hold raw bytes: type 0 is "empty", FMapData interprets the rest.
+ */
+struct FChunkedCellGrid
+{
+	static constexpr int32 ChunkShift = 5;
+	static constexpr int32 ChunkSize = 1 << ChunkShift; // tiles per chunk side
+	static constexpr int32 ChunkMask = ChunkSize - 1;
+	static constexpr int32 CellsPerChunk = ChunkSize * ChunkSize;
+
+	void Init(int32 InWidth, int32 InHeight, bool bWithRoomIds = false, bool bWithFlags = false);
+
+	/** Drops every chunk but keeps directory and plane capacity. */
+	void Reset();
+
+	FORCEINLINE bool IsInBounds(int32 X, int32 Y) const { return X >= 0 && Y >= 0 && X < Width && Y < Height; }
+	FORCEINLINE bool HasRoomIds() const { return bRoomIds; }
+	FORCEINLINE bool HasFlags() const { return bFlags; }
+
+	FORCEINLINE uint8 GetType(int32 X, int32 Y) const
+	{
+		const int32 Slot = FindChunk(X, Y);
+		return Slot != INDEX_NONE ? Types[CellOffset(Slot, X, Y)] : 0;
+	}
+
+	FORCEINLINE void SetType(int32 X, int32 Y, uint8 Type)
+	{
+		const int32 Slot = Type != 0 ? FindOrAddChunk(X, Y) : FindChunk(X, Y);
+		if (Slot != INDEX_NONE) Types[CellOffset(Slot, X, Y)] = Type;
+	}
+
+	FORCEINLINE int32 GetRoomId(int32 X, int32 Y) const
+	{
+		const int32 Slot = bRoomIds ? FindChunk(X, Y) : INDEX_NONE;
+		return Slot != INDEX_NONE ? RoomIds[CellOffset(Slot, X, Y)] : INDEX_NONE;
+	}
+
+	FORCEINLINE void SetRoomId(int32 X, int32 Y, int32 RoomId)
+	{
+		if (!bRoomIds) return;
+		const int32 Slot = RoomId != INDEX_NONE ? FindOrAddChunk(X, Y) : FindChunk(X, Y);
+		if (Slot != INDEX_NONE) RoomIds[CellOffset(Slot, X, Y)] = RoomId;
+	}
+
+	FORCEINLINE uint8 GetFlags(int32 X, int32 Y) const
+	{
+		const int32 Slot = bFlags ? FindChunk(X, Y) : INDEX_NONE;
+		return Slot != INDEX_NONE ? Flags[CellOffset(Slot, X, Y)] : 0;
+	}
+
+	FORCEINLINE void SetFlags(int32 X, int32 Y, uint8 InFlags)
+	{
+		if (!bFlags) return;
+		const int32 Slot = InFlags != 0 ? FindOrAddChunk(X, Y) : FindChunk(X, Y);
+		if (Slot != INDEX_NONE) Flags[CellOffset(Slot, X, Y)] = InFlags;
+	}
+
+	/** Number of allocated chunks. Slots are dense in [0, NumChunks). */
+	FORCEINLINE int32 NumChunks() const { return ChunkCoords.Num(); }
+	FORCEINLINE FIntPoint GetChunkCoord(int32 Slot) const { return ChunkCoords[Slot]; }
+	FORCEINLINE const uint8* GetChunkTypes(int32 Slot) const { return Types.GetData() + Slot * CellsPerChunk; }
+
+	/** Calls Fn(X, Y, Type) for every cell with a non-zero type, walking allocated chunks only. */
+	template <typename FuncType>
+	void ForEachCell(FuncType&& Fn) const
+	{
+		for (int32 Slot = 0; Slot < ChunkCoords.Num(); ++Slot)
+		{
+			const int32 BaseX = ChunkCoords[Slot].X << ChunkShift;
+			const int32 BaseY = ChunkCoords[Slot].Y << ChunkShift;
+			const uint8* ChunkTypes = GetChunkTypes(Slot);
+			for (uint32 Code = 0; Code < (uint32)CellsPerChunk; ++Code)
+			{
+				if (ChunkTypes[Code] == 0) continue;
+				uint32 LX, LY;
+				MortonDecode(Code, LX, LY);
+				Fn(BaseX + (int32)LX, BaseY + (int32)LY, ChunkTypes[Code]);
+			}
+		}
+	}
+
+	/** Bytes one chunk costs across all enabled planes (directory excluded). */
+	SIZE_T GetBytesPerChunk() const;
+	SIZE_T GetAllocatedSize() const;
+	void Serialize(FArchive& Ar);
+
+	static FORCEINLINE uint32 MortonEncode(uint32 X, uint32 Y) { return Part1By1(X) | (Part1By1(Y) << 1); }
+	static FORCEINLINE void MortonDecode(uint32 Code, uint32& OutX, uint32& OutY) { OutX = Compact1By1(Code); OutY = Compact1By1(Code >> 1); }
+
+private:
+	static FORCEINLINE uint32 Part1By1(uint32 V)
+	{
+		V &= 0x0000ffff;
+		V = (V | (V << 8)) & 0x00ff00ff;
+		V = (V | (V << 4)) & 0x0f0f0f0f;
+		V = (V | (V << 2)) & 0x33333333;
+		V = (V | (V << 1)) & 0x55555555;
+		return V;
+	}
+
+	static FORCEINLINE uint32 Compact1By1(uint32 V)
+	{
+		V &= 0x55555555;
+		V = (V | (V >> 1)) & 0x33333333;
+		V = (V | (V >> 2)) & 0x0f0f0f0f;
+		V = (V | (V >> 4)) & 0x00ff00ff;
+		V = (V | (V >> 8)) & 0x0000ffff;
+		return V;
+	}
+
+	FORCEINLINE int32 CellOffset(int32 Slot, int32 X, int32 Y) const
+	{
+		return Slot * CellsPerChunk + (int32)MortonEncode(X & ChunkMask, Y & ChunkMask);
+	}
+
+	FORCEINLINE int32 FindChunk(int32 X, int32 Y) const
+	{
+		return IsInBounds(X, Y) ? Directory[(Y >> ChunkShift) * ChunksX + (X >> ChunkShift)] : INDEX_NONE;
+	}
+
+	int32 FindOrAddChunk(int32 X, int32 Y);
+
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 ChunksX = 0;
+	int32 ChunksY = 0;
+	bool bRoomIds = false;
+	bool bFlags = false;
+
+	TArray<int32> Directory;       // ChunksX * ChunksY, slot or INDEX_NONE
+	TArray<FIntPoint> ChunkCoords; // slot -> chunk coordinate
+	TArray<uint8> Types;           // NumChunks * CellsPerChunk, Morton order per chunk
+	TArray<int32> RoomIds;
+	TArray<uint8> Flags;
+};
@@ -0,0 +1,85 @@
+#include "CorridorCarver.h"
+#include "Algo/Reverse.h"
+
+void FCorridorCarver::Init(int32 InWidth, int32 InHeight)
+{
+	Width = FMath::Max(InWidth, 0);
+	Height = FMath::Max(InHeight, 0);
+	const int32 Num = Width * Height;
+	if (SeenStamp.Num() != Num)
+	{
+		SeenStamp.Init(0, Num);
+		ClosedStamp.Init(0, Num);
+		BestG.SetNumUninitialized(Num, EAllowShrinking::No);
+		CameFrom.SetNumUninitialized(Num, EAllowShrinking::No);
+		Stamp = 0;
+	}
+}
+
+bool FCorridorCarver::FindPath(const FMapData& Map, const FIntPoint& A, const FIntPoint& B, TArray<FIntPoint>& OutCells)
+{
+	OutCells.Reset();
+	LastExpanded = 0;
+	const auto InBounds = [this](int32 X, int32 Y) { return X >= 0 && Y >= 0 && X < Width && Y < Height; };
+	if (!InBounds(A.X, A.Y) || !InBounds(B.X, B.Y)) return false;
+
+	if (++Stamp == 0)
+	{
+		FMemory::Memzero(SeenStamp.GetData(), SeenStamp.Num() * sizeof(uint32));
+		FMemory::Memzero(ClosedStamp.GetData(), ClosedStamp.Num() * sizeof(uint32));
+		Stamp = 1;
+	}
+
+	const auto Heuristic = [&B, this](int32 X, int32 Y) { return HeuristicCost * (FMath::Abs(B.X - X) + FMath::Abs(B.Y - Y)); };
+	const int32 StartCell = A.Y * Width + A.X;
+	const int32 GoalCell = B.Y * Width + B.X;
+	const int32 StartRoom = Map.GetRoomId(A.X, A.Y);
+	const int32 GoalRoom = Map.GetRoomId(B.X, B.Y);
+
+	Open.Reset();
+	SeenStamp[StartCell] = Stamp;
+	BestG[StartCell] = 0;
+	CameFrom[StartCell] = INDEX_NONE;
+	Open.HeapPush({ Heuristic(A.X, A.Y), 0, StartCell });
+
+	static const FIntPoint Dirs[] = { FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1) };
+	bool bFound = false;
+	while (Open.Num() > 0)
+	{
+		FOpenNode Node;
+		Open.HeapPop(Node, EAllowShrinking::No);
+		if (ClosedStamp[Node.Cell] == Stamp) continue;
+		ClosedStamp[Node.Cell] = Stamp;
+		++LastExpanded;
+		if (Node.Cell == GoalCell) { bFound = true; break; }
+
+		const int32 X = Node.Cell % Width;
+		const int32 Y = Node.Cell / Width;
+		for (const FIntPoint& Dir : Dirs)
+		{
+			const int32 NX = X + Dir.X, NY = Y + Dir.Y;
+			if (!InBounds(NX, NY)) continue;
+			const int32 Next = NY * Width + NX;
+			if (ClosedStamp[Next] == Stamp) continue;
+
+			// Leaving the start room or entering the goal room is the point, so those rooms cost like corridor
+			const int32 Room = Map.GetRoomId(NX, NY);
+			const int32 Cost = (Room != INDEX_NONE && (Room == StartRoom || Room == GoalRoom)) ? CorridorCost : StepCost(Map, NX, NY);
+			const int32 G = Node.G + Cost;
+			if (SeenStamp[Next] == Stamp && G >= BestG[Next]) continue;
+
+			SeenStamp[Next] = Stamp;
+			BestG[Next] = G;
+			CameFrom[Next] = Node.Cell;
+			Open.HeapPush({ G + Heuristic(NX, NY), G, Next });
+		}
+	}
+	if (!bFound) return false;
+
+	for (int32 Cell = GoalCell; Cell != INDEX_NONE; Cell = CameFrom[Cell])
+	{
+		OutCells.Add(FIntPoint(Cell % Width, Cell / Width));
+	}
+	Algo::Reverse(OutCells);
+	return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+/**
+ * A* corridor routing on the generation grid. Stepping onto an existing corridor is cheap, open
+ * ground costs more and room interiors (other than where the corridor starts and ends) cost the
+ * most, so later corridors merge into earlier ones instead of running alongside them.
+ *
+ * Search buffers are sized by Init once per generation and reused for every corridor; each search
+ * just bumps a stamp instead of clearing them.
+ */
+struct FCorridorCarver
+{
+	int32 CorridorCost = 1; // existing corridor floor
+	int32 EmptyCost = 4;    // open ground
+	int32 RoomCost = 12;    // room interior
+	int32 HeuristicCost = 4;  // assumed cost per remaining step; matching EmptyCost keeps searches near-linear, lower is closer to optimal but expands far more
+
+	/** Sizes the buffers for a Width x Height map. Keeps allocations from earlier generations. */
+	void Init(int32 InWidth, int32 InHeight);
+
+	/** Cheapest route from A to B (both included) under the cost field. False if either is off the map. */
+	bool FindPath(const FMapData& Map, const FIntPoint& A, const FIntPoint& B, TArray<FIntPoint>& OutCells);
+
+	/** Cells expanded by the last FindPath, for tuning. */
+	int32 GetLastExpanded() const { return LastExpanded; }
+
+private:
+	FORCEINLINE int32 StepCost(const FMapData& Map, int32 X, int32 Y) const
+	{
+		if (Map.IsEmpty(X, Y)) return EmptyCost;
+		return Map.GetRoomId(X, Y) == INDEX_NONE ? CorridorCost : RoomCost;
+	}
+
+	struct FOpenNode
+	{
+		int32 F;
+		int32 G;
+		int32 Cell;
+		bool operator<(const FOpenNode& Other) const { return F < Other.F || (F == Other.F && G > Other.G); }
+	};
+
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<uint32> SeenStamp;   // cell has a G this search
+	TArray<uint32> ClosedStamp; // cell was expanded this search
+	TArray<int32> BestG;
+	TArray<int32> CameFrom;
+	TArray<FOpenNode> Open;
+	uint32 Stamp = 0;
+	int32 LastExpanded = 0;
+};
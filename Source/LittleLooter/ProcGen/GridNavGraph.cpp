@@ -0,0 +1,270 @@
+#include "GridNavGraph.h"
+#include "Algo/Reverse.h"
+
+void FGridNavGraph::Reset()
+{
+	Width = Height = 0;
+	PolyOf.Reset();
+	Polys.Reset();
+	Links.Reset();
+}
+
+void FGridNavGraph::Build(const FMapData& Map)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	Reset();
+	Width = Map.GetWidth();
+	Height = Map.GetHeight();
+	PolyOf.Init(INDEX_NONE, Width * Height);
+
+	const auto IsFree = [this, &Map](int32 X, int32 Y) { return PolyOf[Y * Width + X] == INDEX_NONE && Map.IsWalkable(X, Y); };
+
+	// Greedy rectangles in row-major order: take the widest free run, then grow it down while
+	// the whole run stays free. Rooms come out as one rect each, corridors as a few long strips.
+	for (int32 y = 0; y < Height; ++y)
+		for (int32 x = 0; x < Width; ++x)
+		{
+			if (!IsFree(x, y)) continue;
+
+			int32 MaxX = x + 1;
+			while (MaxX < Width && IsFree(MaxX, y)) ++MaxX;
+
+			int32 MaxY = y + 1;
+			for (; MaxY < Height; ++MaxY)
+			{
+				bool bRowFree = true;
+				for (int32 xx = x; xx < MaxX && bRowFree; ++xx) bRowFree = IsFree(xx, MaxY);
+				if (!bRowFree) break;
+			}
+
+			const int32 PolyIndex = Polys.AddDefaulted();
+			Polys[PolyIndex].Rect = FIntRect(x, y, MaxX, MaxY);
+			for (int32 yy = y; yy < MaxY; ++yy)
+				for (int32 xx = x; xx < MaxX; ++xx)
+				{
+					PolyOf[yy * Width + xx] = PolyIndex;
+				}
+		}
+
+	// Portals: walk each rect's border and emit one link per run of cells facing the same neighbor
+	for (int32 PolyIndex = 0; PolyIndex < Polys.Num(); ++PolyIndex)
+	{
+		FPoly& Poly = Polys[PolyIndex];
+		const FIntRect& R = Poly.Rect;
+		Poly.FirstLink = Links.Num();
+
+		// Edge is the grid line the portal lies on; Outside the row/column of neighbor cells beyond it
+		const auto AddSide = [this](bool bVertical, int32 Edge, int32 Outside, int32 From, int32 To, bool bForward)
+		{
+			int32 RunStart = From;
+			int32 RunPoly = INDEX_NONE;
+			for (int32 i = From; i <= To; ++i)
+			{
+				const int32 Neighbor = i < To ? (bVertical ? FindPoly(FIntPoint(Outside, i)) : FindPoly(FIntPoint(i, Outside))) : INDEX_NONE;
+				if (Neighbor == RunPoly) continue;
+				if (RunPoly != INDEX_NONE)
+				{
+					// Left/right as seen walking out through this side
+					const FVector2D Lo = bVertical ? FVector2D(Edge, RunStart) : FVector2D(RunStart, Edge);
+					const FVector2D Hi = bVertical ? FVector2D(Edge, i) : FVector2D(i, Edge);
+					FLink& Link = Links.AddDefaulted_GetRef();
+					Link.Poly = RunPoly;
+					Link.Left = (bVertical == bForward) ? Hi : Lo;
+					Link.Right = (bVertical == bForward) ? Lo : Hi;
+				}
+				RunPoly = Neighbor;
+				RunStart = i;
+			}
+		};
+		AddSide(/*bVertical*/ true,  R.Max.X, R.Max.X,     R.Min.Y, R.Max.Y, /*bForward*/ true);  // east, +X
+		AddSide(/*bVertical*/ true,  R.Min.X, R.Min.X - 1, R.Min.Y, R.Max.Y, /*bForward*/ false); // west, -X
+		AddSide(/*bVertical*/ false, R.Max.Y, R.Max.Y,     R.Min.X, R.Max.X, /*bForward*/ true);  // north, +Y
+		AddSide(/*bVertical*/ false, R.Min.Y, R.Min.Y - 1, R.Min.X, R.Max.X, /*bForward*/ false); // south, -Y
+
+		Polys[PolyIndex].NumLinks = Links.Num() - Polys[PolyIndex].FirstLink;
+	}
+
+	BuildSeconds = FPlatformTime::Seconds() - StartSeconds;
+}
+
+bool FGridNavGraph::FindPolyPath(int32 StartPoly, int32 EndPoly, const FVector2D& Start, const FVector2D& End, TArray<int32>& OutPolys) const
+{
+	OutPolys.Reset();
+	if (!Polys.IsValidIndex(StartPoly) || !Polys.IsValidIndex(EndPoly)) return false;
+
+	if (Visited.Num() != Polys.Num())
+	{
+		Visited.Init(0, Polys.Num());
+		BestG.SetNumUninitialized(Polys.Num());
+		ParentPoly.SetNumUninitialized(Polys.Num());
+		ParentLink.SetNumUninitialized(Polys.Num());
+		EntryPoint.SetNumUninitialized(Polys.Num());
+		SearchStamp = 0;
+	}
+	if (++SearchStamp == 0)
+	{
+		FMemory::Memzero(Visited.GetData(), Visited.Num() * sizeof(uint32));
+		SearchStamp = 1;
+	}
+
+	Open.Reset();
+	Visited[StartPoly] = SearchStamp;
+	BestG[StartPoly] = 0.f;
+	ParentPoly[StartPoly] = INDEX_NONE;
+	ParentLink[StartPoly] = INDEX_NONE;
+	EntryPoint[StartPoly] = Start;
+	Open.HeapPush({ (float)FVector2D::Distance(Start, End), 0.f, StartPoly });
+
+	bool bFound = false;
+	while (Open.Num() > 0)
+	{
+		FOpenNode Node;
+		Open.HeapPop(Node, EAllowShrinking::No);
+		if (Node.G > BestG[Node.Poly]) continue; // superseded
+		if (Node.Poly == EndPoly) { bFound = true; break; }
+
+		const FPoly& Poly = Polys[Node.Poly];
+		const FVector2D& From = EntryPoint[Node.Poly];
+		for (int32 LinkIndex = Poly.FirstLink; LinkIndex < Poly.FirstLink + Poly.NumLinks; ++LinkIndex)
+		{
+			const FLink& Link = Links[LinkIndex];
+
+			// Enter the neighbor at the portal point closest to where we entered this poly
+			const FVector2D Entry(
+				FMath::Clamp(From.X, FMath::Min(Link.Left.X, Link.Right.X), FMath::Max(Link.Left.X, Link.Right.X)),
+				FMath::Clamp(From.Y, FMath::Min(Link.Left.Y, Link.Right.Y), FMath::Max(Link.Left.Y, Link.Right.Y)));
+			const float G = Node.G + (float)FVector2D::Distance(From, Entry);
+			if (Visited[Link.Poly] == SearchStamp && G >= BestG[Link.Poly]) continue;
+
+			Visited[Link.Poly] = SearchStamp;
+			BestG[Link.Poly] = G;
+			ParentPoly[Link.Poly] = Node.Poly;
+			ParentLink[Link.Poly] = LinkIndex;
+			EntryPoint[Link.Poly] = Entry;
+			Open.HeapPush({ G + (float)FVector2D::Distance(Entry, End), G, Link.Poly });
+		}
+	}
+	if (!bFound) return false;
+
+	for (int32 Poly = EndPoly; Poly != INDEX_NONE; Poly = ParentPoly[Poly]) OutPolys.Add(Poly);
+	Algo::Reverse(OutPolys);
+	return true;
+}
+
+bool FGridNavGraph::FindPath(const FVector2D& Start, const FVector2D& End, TArray<FVector2D>& OutPoints, float CornerMargin) const
+{
+	OutPoints.Reset();
+	if (!FindPolyPath(FindPoly(Start), FindPoly(End), Start, End, PolyPath)) return false;
+
+	// Portals along the corridor, start and end as degenerate portals, pulled in from the corners
+	TArray<FVector2D, TInlineAllocator<64>> Lefts, Rights;
+	Lefts.Add(Start);
+	Rights.Add(Start);
+	for (int32 i = 1; i < PolyPath.Num(); ++i)
+	{
+		const FLink& Link = Links[ParentLink[PolyPath[i]]];
+		const FVector2D Span = Link.Right - Link.Left;
+		const float Length = (float)Span.Size();
+		const FVector2D Inset = Span * (FMath::Min(CornerMargin, Length * 0.5f) / FMath::Max(Length, UE_KINDA_SMALL_NUMBER));
+		Lefts.Add(Link.Left + Inset);
+		Rights.Add(Link.Right - Inset);
+	}
+	Lefts.Add(End);
+	Rights.Add(End);
+
+	// Simple stupid funnel: keep the tightest left/right edges from the apex and emit a corner
+	// whenever one edge crosses over the other
+	const auto Cross = [](const FVector2D& A, const FVector2D& B) { return A.X * B.Y - A.Y * B.X; };
+	FVector2D Apex = Start, Left = Start, Right = Start;
+	int32 ApexIndex = 0, LeftIndex = 0, RightIndex = 0;
+	OutPoints.Add(Start);
+	for (int32 i = 1; i < Lefts.Num(); ++i)
+	{
+		const FVector2D& NewLeft = Lefts[i];
+		const FVector2D& NewRight = Rights[i];
+
+		if (Cross(Right - Apex, NewRight - Apex) >= 0.f)
+		{
+			if (Apex == Right || Cross(Left - Apex, NewRight - Apex) < 0.f)
+			{
+				Right = NewRight;
+				RightIndex = i;
+			}
+			else
+			{
+				Apex = Left;
+				ApexIndex = LeftIndex;
+				OutPoints.Add(Apex);
+				Left = Right = Apex;
+				LeftIndex = RightIndex = ApexIndex;
+				i = ApexIndex;
+				continue;
+			}
+		}
+
+		if (Cross(Left - Apex, NewLeft - Apex) <= 0.f)
+		{
+			if (Apex == Left || Cross(Right - Apex, NewLeft - Apex) > 0.f)
+			{
+				Left = NewLeft;
+				LeftIndex = i;
+			}
+			else
+			{
+				Apex = Right;
+				ApexIndex = RightIndex;
+				OutPoints.Add(Apex);
+				Left = Right = Apex;
+				LeftIndex = RightIndex = ApexIndex;
+				i = ApexIndex;
+				continue;
+			}
+		}
+	}
+	if (OutPoints.Last() != End) OutPoints.Add(End);
+	return true;
+}
+
+bool FGridNavGraph::Raycast(const FVector2D& Start, const FVector2D& End, FVector2D& OutHit) const
+{
+	FIntPoint Cell(FMath::FloorToInt(Start.X), FMath::FloorToInt(Start.Y));
+	if (FindPoly(Cell) == INDEX_NONE)
+	{
+		OutHit = Start;
+		return true;
+	}
+
+	// Cell by cell along the segment (Amanatides-Woo); T is the fraction of Start->End at each crossing
+	const FVector2D Dir = End - Start;
+	const FIntPoint EndCell(FMath::FloorToInt(End.X), FMath::FloorToInt(End.Y));
+	const int32 StepX = Dir.X > 0.0 ? 1 : -1;
+	const int32 StepY = Dir.Y > 0.0 ? 1 : -1;
+	const double DeltaX = Dir.X != 0.0 ? FMath::Abs(1.0 / Dir.X) : UE_DOUBLE_BIG_NUMBER;
+	const double DeltaY = Dir.Y != 0.0 ? FMath::Abs(1.0 / Dir.Y) : UE_DOUBLE_BIG_NUMBER;
+	double NextX = Dir.X != 0.0 ? (StepX > 0 ? Cell.X + 1 - Start.X : Start.X - Cell.X) * DeltaX : UE_DOUBLE_BIG_NUMBER;
+	double NextY = Dir.Y != 0.0 ? (StepY > 0 ? Cell.Y + 1 - Start.Y : Start.Y - Cell.Y) * DeltaY : UE_DOUBLE_BIG_NUMBER;
+	while (Cell != EndCell)
+	{
+		double T;
+		if (NextX < NextY)
+		{
+			T = NextX;
+			NextX += DeltaX;
+			Cell.X += StepX;
+		}
+		else
+		{
+			T = NextY;
+			NextY += DeltaY;
+			Cell.Y += StepY;
+		}
+		if (T > 1.0) break; // rounding at the last crossing
+		if (FindPoly(Cell) == INDEX_NONE)
+		{
+			OutHit = Start + Dir * T;
+			return true;
+		}
+	}
+	OutHit = End;
+	return false;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+/**
+ * Navigation built straight from the grid instead of voxelized collision. Walkable cells are merged
+ * into axis-aligned rectangles (convex polys) linked by portals along their shared edges; queries run
+ * A* over the rectangles and string-pull through the portals.
+ *
+ * Points are in grid units: cell (X, Y) covers [X, X+1) x [Y, Y+1). Queries reuse scratch buffers,
+ * so one graph must only be queried from one thread at a time.
+ */
+struct FGridNavGraph
+{
+	struct FPoly
+	{
+		FIntRect Rect;
+		int32 FirstLink = 0;
+		int32 NumLinks = 0;
+	};
+
+	/** One side of a shared edge, with endpoints ordered for travel from the owning poly into Poly. */
+	struct FLink
+	{
+		int32 Poly = INDEX_NONE;
+		FVector2D Left;
+		FVector2D Right;
+	};
+
+	void Reset();
+
+	/** Rebuilds polys and portals from Map's walkable (Floor/Door) cells. */
+	void Build(const FMapData& Map);
+
+	bool IsBuilt() const { return PolyOf.Num() > 0; }
+
+	/** Poly covering Cell, INDEX_NONE if Cell isn't walkable. */
+	FORCEINLINE int32 FindPoly(const FIntPoint& Cell) const
+	{
+		return (Cell.X >= 0 && Cell.Y >= 0 && Cell.X < Width && Cell.Y < Height) ? PolyOf[Cell.Y * Width + Cell.X] : INDEX_NONE;
+	}
+	FORCEINLINE int32 FindPoly(const FVector2D& Point) const
+	{
+		return FindPoly(FIntPoint(FMath::FloorToInt(Point.X), FMath::FloorToInt(Point.Y)));
+	}
+
+	/** A* over polys. OutPolys runs from StartPoly to EndPoly; false if they aren't connected. */
+	bool FindPolyPath(int32 StartPoly, int32 EndPoly, const FVector2D& Start, const FVector2D& End, TArray<int32>& OutPolys) const;
+
+	/**
+	 * Straightest path from Start to End (both on walkable cells), including both ends.
+	 * Corners are kept CornerMargin grid units clear of walls where the portals are wide enough.
+	 */
+	bool FindPath(const FVector2D& Start, const FVector2D& End, TArray<FVector2D>& OutPoints, float CornerMargin = 0.25f) const;
+
+	/** Walks the cells from Start to End; true if it leaves walkable cells, with OutHit where it does. */
+	bool Raycast(const FVector2D& Start, const FVector2D& End, FVector2D& OutHit) const;
+
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+	int32 NumPolys() const { return Polys.Num(); }
+	int32 NumLinks() const { return Links.Num(); }
+	const FPoly& GetPoly(int32 Index) const { return Polys[Index]; }
+	const FLink& GetLink(int32 Index) const { return Links[Index]; }
+	double GetBuildSeconds() const { return BuildSeconds; }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return PolyOf.GetAllocatedSize() + Polys.GetAllocatedSize() + Links.GetAllocatedSize();
+	}
+
+private:
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<int32> PolyOf; // poly per cell, row-major
+	TArray<FPoly> Polys;
+	TArray<FLink> Links;  // grouped per poly
+	double BuildSeconds = 0.0;
+
+	// A* scratch, valid for polys whose Visited entry matches SearchStamp
+	struct FOpenNode
+	{
+		float F;
+		float G;
+		int32 Poly;
+		bool operator<(const FOpenNode& Other) const { return F < Other.F; }
+	};
+	mutable TArray<uint32> Visited;
+	mutable TArray<float> BestG;
+	mutable TArray<int32> ParentPoly;
+	mutable TArray<int32> ParentLink; // link of ParentPoly that reached the poly
+	mutable TArray<FVector2D> EntryPoint;
+	mutable TArray<FOpenNode> Open;
+	mutable TArray<int32> PolyPath;
+	mutable uint32 SearchStamp = 0;
+};
@@ -0,0 +1,235 @@
+#include "GridPathfinder.h"
+#include "Algo/Reverse.h"
+
+void FGridPathfinder::Init(const FMapData& Map)
+{
+	Reset();
+	Width = Map.GetWidth();
+	Height = Map.GetHeight();
+	Walkable.SetNumUninitialized(Width * Height);
+	UpdateRegion(Map, FIntRect(0, 0, Width, Height));
+}
+
+void FGridPathfinder::UpdateRegion(const FMapData& Map, const FIntRect& Region)
+{
+	for (int32 y = FMath::Max(Region.Min.Y, 0); y < FMath::Min(Region.Max.Y, Height); ++y)
+		for (int32 x = FMath::Max(Region.Min.X, 0); x < FMath::Min(Region.Max.X, Width); ++x)
+		{
+			Walkable[y * Width + x] = Map.IsWalkable(x, y) ? 1 : 0;
+		}
+	FlowFields.Reset();
+}
+
+void FGridPathfinder::Reset()
+{
+	Width = Height = 0;
+	Walkable.Reset();
+	FlowFields.Reset();
+	Visited.Reset();
+}
+
+// Canonical 4-connected paths take vertical steps as early as possible, so a horizontal run only
+// has to stop where a cell above or below opens up that couldn't be reached one step earlier,
+// and a vertical run stops wherever a horizontal run from it would find something.
+
+int32 FGridPathfinder::JumpHorizontal(int32 X, int32 Y, int32 DX, const FIntPoint& Goal) const
+{
+	for (;;)
+	{
+		X += DX;
+		if (!IsWalkable(X, Y)) return INDEX_NONE;
+		if (X == Goal.X && Y == Goal.Y) return Y * Width + X;
+		if ((IsWalkable(X, Y + 1) && !IsWalkable(X - DX, Y + 1)) || (IsWalkable(X, Y - 1) && !IsWalkable(X - DX, Y - 1)))
+		{
+			return Y * Width + X;
+		}
+	}
+}
+
+int32 FGridPathfinder::JumpVertical(int32 X, int32 Y, int32 DY, const FIntPoint& Goal) const
+{
+	for (;;)
+	{
+		Y += DY;
+		if (!IsWalkable(X, Y)) return INDEX_NONE;
+		if (X == Goal.X && Y == Goal.Y) return Y * Width + X;
+		if (JumpHorizontal(X, Y, 1, Goal) != INDEX_NONE || JumpHorizontal(X, Y, -1, Goal) != INDEX_NONE)
+		{
+			return Y * Width + X;
+		}
+	}
+}
+
+bool FGridPathfinder::FindPath(const FIntPoint& Start, const FIntPoint& Goal, TArray<FIntPoint>& OutCells) const
+{
+	OutCells.Reset();
+	if (!IsWalkable(Start.X, Start.Y) || !IsWalkable(Goal.X, Goal.Y)) return false;
+
+	const int32 NumCells = Width * Height;
+	if (Visited.Num() != NumCells)
+	{
+		Visited.Init(0, NumCells);
+		BestG.SetNumUninitialized(NumCells);
+		Parent.SetNumUninitialized(NumCells);
+		SearchStamp = 0;
+	}
+	if (++SearchStamp == 0)
+	{
+		FMemory::Memzero(Visited.GetData(), Visited.Num() * sizeof(uint32));
+		SearchStamp = 1;
+	}
+
+	const auto Heuristic = [&Goal](int32 X, int32 Y) { return FMath::Abs(Goal.X - X) + FMath::Abs(Goal.Y - Y); };
+	const int32 StartCell = Start.Y * Width + Start.X;
+	const int32 GoalCell = Goal.Y * Width + Goal.X;
+
+	Open.Reset();
+	Visited[StartCell] = SearchStamp;
+	BestG[StartCell] = 0;
+	Parent[StartCell] = INDEX_NONE;
+	Open.HeapPush({ Heuristic(Start.X, Start.Y), 0, StartCell });
+
+	bool bFound = false;
+	while (Open.Num() > 0)
+	{
+		FOpenNode Node;
+		Open.HeapPop(Node, EAllowShrinking::No);
+		if (Node.G > BestG[Node.Cell]) continue; // superseded
+		if (Node.Cell == GoalCell) { bFound = true; break; }
+
+		const int32 X = Node.Cell % Width;
+		const int32 Y = Node.Cell / Width;
+		const auto Consider = [&](int32 JumpCell)
+		{
+			if (JumpCell == INDEX_NONE) return;
+			const int32 JX = JumpCell % Width;
+			const int32 JY = JumpCell / Width;
+			const int32 G = Node.G + FMath::Abs(JX - X) + FMath::Abs(JY - Y);
+			if (Visited[JumpCell] == SearchStamp && G >= BestG[JumpCell]) return;
+			Visited[JumpCell] = SearchStamp;
+			BestG[JumpCell] = G;
+			Parent[JumpCell] = Node.Cell;
+			Open.HeapPush({ G + Heuristic(JX, JY), G, JumpCell });
+		};
+
+		// Prune by the direction we arrived from; the start expands all four
+		const int32 From = Parent[Node.Cell];
+		const int32 DX = From == INDEX_NONE ? 0 : FMath::Sign(X - From % Width);
+		const int32 DY = From == INDEX_NONE ? 0 : FMath::Sign(Y - From / Width);
+		if (DX != 0)
+		{
+			Consider(JumpHorizontal(X, Y, DX, Goal));
+			if (IsWalkable(X, Y + 1) && !IsWalkable(X - DX, Y + 1)) Consider(JumpVertical(X, Y, 1, Goal));
+			if (IsWalkable(X, Y - 1) && !IsWalkable(X - DX, Y - 1)) Consider(JumpVertical(X, Y, -1, Goal));
+		}
+		else
+		{
+			if (DY >= 0) Consider(JumpVertical(X, Y, 1, Goal));
+			if (DY <= 0) Consider(JumpVertical(X, Y, -1, Goal));
+			Consider(JumpHorizontal(X, Y, 1, Goal));
+			Consider(JumpHorizontal(X, Y, -1, Goal));
+		}
+	}
+	if (!bFound) return false;
+
+	// Jump points are joined by straight runs; fill in the cells between them
+	for (int32 Cell = GoalCell; Cell != INDEX_NONE; Cell = Parent[Cell])
+	{
+		const FIntPoint To(Cell % Width, Cell / Width);
+		OutCells.Add(To);
+		if (Parent[Cell] == INDEX_NONE) break;
+
+		const FIntPoint From(Parent[Cell] % Width, Parent[Cell] / Width);
+		const FIntPoint Step(FMath::Sign(From.X - To.X), FMath::Sign(From.Y - To.Y));
+		for (FIntPoint P = To + Step; P != From; P += Step) OutCells.Add(P);
+	}
+	Algo::Reverse(OutCells);
+	return true;
+}
+
+const FGridFlowField* FGridPathfinder::GetFlowField(const FIntPoint& Target)
+{
+	if (!IsWalkable(Target.X, Target.Y)) return nullptr;
+
+	for (FGridFlowField& Field : FlowFields)
+	{
+		if (Field.Target == Target)
+		{
+			Field.LastUsed = ++UseCounter;
+			++FlowFieldHits;
+			return &Field;
+		}
+	}
+
+	// Reuse the least recently used field's buffer once the cache is full
+	FGridFlowField* Field = nullptr;
+	if (FlowFields.Num() < FMath::Max(MaxFlowFields, 1))
+	{
+		Field = &FlowFields.AddDefaulted_GetRef();
+	}
+	else
+	{
+		Field = &FlowFields[0];
+		for (FGridFlowField& Candidate : FlowFields)
+		{
+			if (Candidate.LastUsed < Field->LastUsed) Field = &Candidate;
+		}
+	}
+	Field->Target = Target;
+	Field->LastUsed = ++UseCounter;
+	BuildFlowField(*Field);
+	++FlowFieldBuilds;
+	return Field;
+}
+
+void FGridPathfinder::BuildFlowField(FGridFlowField& Field) const
+{
+	Field.Distance.Init(INDEX_NONE, Width * Height);
+
+	// Plain BFS: every step costs the same
+	TArray<int32> Queue;
+	Queue.Reserve(Width * Height / 4);
+	const int32 TargetCell = Field.Target.Y * Width + Field.Target.X;
+	Field.Distance[TargetCell] = 0;
+	Queue.Add(TargetCell);
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
+	{
+		const int32 Cell = Queue[Head];
+		const int32 X = Cell % Width;
+		const int32 Y = Cell / Width;
+		const int32 Next = Field.Distance[Cell] + 1;
+		const auto Visit = [&](int32 NX, int32 NY)
+		{
+			if (!IsWalkable(NX, NY)) return;
+			const int32 NCell = NY * Width + NX;
+			if (Field.Distance[NCell] != INDEX_NONE) return;
+			Field.Distance[NCell] = Next;
+			Queue.Add(NCell);
+		};
+		Visit(X + 1, Y);
+		Visit(X - 1, Y);
+		Visit(X, Y + 1);
+		Visit(X, Y - 1);
+	}
+}
+
+bool FGridPathfinder::GetNextStep(const FIntPoint& From, const FIntPoint& Target, FIntPoint& OutNext)
+{
+	const FGridFlowField* Field = GetFlowField(Target);
+	if (!Field || !IsWalkable(From.X, From.Y)) return false;
+
+	const int32 Distance = Field->Distance[From.Y * Width + From.X];
+	if (Distance <= 0) return false;
+
+	static const FIntPoint Offsets[] = { FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1) };
+	for (const FIntPoint& Offset : Offsets)
+	{
+		const FIntPoint Next = From + Offset;
+		if (IsWalkable(Next.X, Next.Y) && Field->Distance[Next.Y * Width + Next.X] == Distance - 1)
+		{
+			OutNext = Next;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+/** Steps to one target from every cell, from a single BFS. */
+struct FGridFlowField
+{
+	FIntPoint Target = FIntPoint(INDEX_NONE, INDEX_NONE);
+	TArray<int32> Distance; // row-major, INDEX_NONE where the target can't be reached
+	uint64 LastUsed = 0;
+};
+
+/**
+ * Cell-level pathfinding on the 4-connected walkable (Floor/Door) grid.
+ * Point-to-point queries use Jump Point Search; agents sharing a target (the player, the exit)
+ * share one cached flow field instead of each running a search.
+ *
+ * Works on a snapshot of walkability taken by Init/UpdateRegion. Not thread-safe: queries reuse
+ * scratch buffers and flow field lookups update the cache.
+ */
+struct FGridPathfinder
+{
+	/** Flow fields kept before the least recently used one is dropped. */
+	int32 MaxFlowFields = 8;
+
+	void Init(const FMapData& Map);
+
+	/** Re-reads walkability inside Region (clipped) after cells changed and drops every cached flow field. */
+	void UpdateRegion(const FMapData& Map, const FIntRect& Region);
+
+	void Reset();
+
+	FORCEINLINE bool IsWalkable(int32 X, int32 Y) const
+	{
+		return X >= 0 && Y >= 0 && X < Width && Y < Height && Walkable[Y * Width + X] != 0;
+	}
+
+	/** Shortest 4-connected path, Start and Goal included. False if either is blocked or they aren't connected. */
+	bool FindPath(const FIntPoint& Start, const FIntPoint& Goal, TArray<FIntPoint>& OutCells) const;
+
+	/** Flow field towards Target, built on first use. Null if Target isn't walkable. Valid until the next call. */
+	const FGridFlowField* GetFlowField(const FIntPoint& Target);
+
+	/** Next cell from From towards Target along its flow field. False if unreachable or already there. */
+	bool GetNextStep(const FIntPoint& From, const FIntPoint& Target, FIntPoint& OutNext);
+
+	int32 NumFlowFields() const { return FlowFields.Num(); }
+	int32 GetFlowFieldBuilds() const { return FlowFieldBuilds; }
+	int32 GetFlowFieldHits() const { return FlowFieldHits; }
+
+private:
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<uint8> Walkable;
+
+	TArray<FGridFlowField> FlowFields;
+	uint64 UseCounter = 0;
+	int32 FlowFieldBuilds = 0;
+	int32 FlowFieldHits = 0;
+
+	int32 JumpHorizontal(int32 X, int32 Y, int32 DX, const FIntPoint& Goal) const;
+	int32 JumpVertical(int32 X, int32 Y, int32 DY, const FIntPoint& Goal) const;
+	void BuildFlowField(FGridFlowField& Field) const;
+
+	// JPS scratch, valid for cells whose Visited entry matches SearchStamp
+	struct FOpenNode
+	{
+		int32 F;
+		int32 G;
+		int32 Cell;
+		bool operator<(const FOpenNode& Other) const { return F < Other.F || (F == Other.F && G > Other.G); }
+	};
+	mutable TArray<uint32> Visited;
+	mutable TArray<int32> BestG;
+	mutable TArray<int32> Parent;
+	mutable TArray<FOpenNode> Open;
+	mutable uint32 SearchStamp = 0;
+};
@@ -1,4 +1,7 @@
 #include "MapGenerator.h"
+#include "ProcRandom.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeExit.h"
 
 static FORCEINLINE FIntPoint RandPoint(FRandomStream& R, int32 MinX, int32 MinY, int32 MaxX, int32 MaxY) // Not used yet
 {
@@ -7,93 +10,454 @@ static FORCEINLINE FIntPoint RandPoint(FRandomStream& R, int32 MinX, int32 MinY,
 
 FMapData UMapGenerator::Run(const FProcGenParams& Params, int32 Seed)
 {
-	FRandomStream Rand(Seed);
 	FMapData Map;
+	Run(Params, Seed, Map);
+	return Map;
+}
+
+void UMapGenerator::Run(const FProcGenParams& Params, int32 Seed, FMapData& Map, FProcGenJobState* Job)
+{
+	const auto IsCancelled = [Job]() { return Job && Job->IsCancelled(); };
+	const auto ReportProgress = [Job](float Progress) { if (Job) Job->SetProgress(Progress); };
+	const double RunStart = FPlatformTime::Seconds();
+	Map.Stats = FMapGenStats();
+
+	// Reject mode lays out again from derived seeds until a layout passes validation
+	const int32 MaxAttempts = Params.Validation == EMapValidation::Reject ? 1 + FMath::Max(Params.MaxValidationRetries, 0) : 1;
+	for (int32 Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+	{
+		const int32 LayoutSeed = Attempt == 0 ? Seed : (int32)HashCombine(GetTypeHash(Seed), GetTypeHash(Attempt));
+		if (!BuildLayout(Params, LayoutSeed, Map, Job)) return;
+		// No room fit: a failed attempt like a failed validation, so Reject mode tries the next seed
+		if (Map.Rooms.Num() == 0) continue;
+
+		// 3) Validate connectivity before walls, so repair corridors only ever carve through empty cells
+		if (IsCancelled()) return;
+		ReportProgress(0.8f);
+		const double ValidationStart = FPlatformTime::Seconds();
+		BuildOccupancyBits(Map, Params.bParallelChunks);
+		if (Params.Validation != EMapValidation::Off)
+		{
+			Validate(Params, Map);
+			Map.Validation.Attempts = Attempt + 1;
+			Map.Validation.Seed = LayoutSeed;
+		}
+		Map.Stats.ValidationSeconds += FPlatformTime::Seconds() - ValidationStart;
+		if (Params.Validation == EMapValidation::Off || Map.Validation.bPassed) break;
+	}
+
+	// 4) Walls pass: empty cells adjacent to floor -> wall, plus open-edge flags for the HISM pass
+	const double WallsStart = FPlatformTime::Seconds();
+	BuildWallsAndEdges(Map, Params.bParallelChunks);
+	Map.Stats.WallsSeconds = FPlatformTime::Seconds() - WallsStart;
+	Map.Stats.TotalSeconds = FPlatformTime::Seconds() - RunStart;
+	ReportProgress(1.f);
+}
+
+bool UMapGenerator::BuildLayout(const FProcGenParams& Params, int32 Seed, FMapData& Map, FProcGenJobState* Job)
+{
+	const auto IsCancelled = [Job]() { return Job && Job->IsCancelled(); };
+	const auto ReportProgress = [Job](float Progress) { if (Job) Job->SetProgress(Progress); };
+
+	// Parallel mode never draws rooms from this stream, so corridors get a stream of their own pass
+	FRandomStream Rand(Params.bParallelChunks ? FProcRandom(Seed, FIntPoint::ZeroValue, EProcGenPass::Connect).NextSeed() : Seed);
+	Map.Reset();
+	Map.InitStorage(Params.Storage, Params.Width, Params.Height, /*bWithRoomIds*/ true, /*bWithFlags*/ true);
+	RoomIndex.Init(Params.Width, Params.Height, FMath::Max(Params.MaxRoomSize + 2, 4));
+
+	// 1) Rooms
+	const double RoomsStart = FPlatformTime::Seconds();
+	if (Params.bParallelChunks)
+	{
+		if (!PlaceRoomsParallel(Params, Seed, Map, Job)) return false;
+	}
+	else
+	{
+		IRoomLayoutStrategy& Layout = GetLayoutStrategy(Params.Layout);
+		int32 Attempts = 0;
+		const FRoomLayoutContext Context{ [this, &Map, &Attempts](const FIntRect& Rect) { ++Attempts; return TryAddRoom(Map, Rect); }, Job };
+		const double LayoutStart = FPlatformTime::Seconds();
+		const bool bPlaced = Layout.PlaceRooms(Params, Rand, Context);
+		RecordLayoutStats(Layout, Map, Attempts, FPlatformTime::Seconds() - LayoutStart);
+		if (!bPlaced) return false;
+	}
+
+	Map.Stats.RoomsSeconds += FPlatformTime::Seconds() - RoomsStart;
+	if (Map.Rooms.Num() == 0) return true; // nothing to connect; Run decides what an empty layout means
 
-	// 1) Rooms: rejection sampling rectangles
-	for (int32 i = 0; i < Params.RoomAttempts; ++i)
-	{
-		const int32 W = Rand.RandRange(Params.MinRoomSize, Params.MaxRoomSize);
-		const int32 H = Rand.RandRange(Params.MinRoomSize, Params.MaxRoomSize);
-		const int32 X = Rand.RandRange(1, Params.Width - W - 2);
-		const int32 Y = Rand.RandRange(1, Params.Height - H - 2);
-		FIntRect Rect(X, Y, X + W, Y + H);
-		if (IntersectsExisting(Map, Rect)) continue;
-		StampRoom(Map, Rect);
-		FRoom Rm; Rm.Bounds = Rect; Map.Rooms.Add(Rm);
-	}
-
-	if (Map.Rooms.Num() == 0) return Map; // nothing to do
-
-	// 2) Connect rooms in sequence (MVP). Then add a few extra corridors.
-	for (int32 i = 1; i < Map.Rooms.Num(); ++i)
-	{
-		const FIntPoint A((Map.Rooms[i - 1].Bounds.Min.X + Map.Rooms[i - 1].Bounds.Max.X) / 2,
-			(Map.Rooms[i - 1].Bounds.Min.Y + Map.Rooms[i - 1].Bounds.Max.Y) / 2);
-		const FIntPoint B((Map.Rooms[i].Bounds.Min.X + Map.Rooms[i].Bounds.Max.X) / 2,
-			(Map.Rooms[i].Bounds.Min.Y + Map.Rooms[i].Bounds.Max.Y) / 2);
-		CarveCorridor(Map, A, B);
-	}
-	for (int32 k = 0; k < Params.ExtraCorridors && Map.Rooms.Num() > 1; ++k)
-	{
-		int32 I = Rand.RandRange(0, Map.Rooms.Num() - 1);
-		int32 J = Rand.RandRange(0, Map.Rooms.Num() - 1);
-		if (I == J) continue;
-		const FIntPoint A((Map.Rooms[I].Bounds.Min.X + Map.Rooms[I].Bounds.Max.X) / 2,
-			(Map.Rooms[I].Bounds.Min.Y + Map.Rooms[I].Bounds.Max.Y) / 2);
-		const FIntPoint B((Map.Rooms[J].Bounds.Min.X + Map.Rooms[J].Bounds.Max.X) / 2,
-			(Map.Rooms[J].Bounds.Min.Y + Map.Rooms[J].Bounds.Max.Y) / 2);
-		CarveCorridor(Map, A, B);
-	}
-
-	// 3) Walls pass: empty cells adjacent to floor ? wall
-	auto IsFloor = [&Map](int32 X, int32 Y) {
-		const FCell* C = Map.Cells.Find(FIntPoint(X, Y));
-		return C && (C->Type == ECellType::Floor || C->Type == ECellType::Door);
-		};
-	for (int32 y = 0; y < Params.Height; ++y)
-		for (int32 x = 0; x < Params.Width; ++x)
+	// 2) Connect rooms (timed on every exit, cancels included)
+	const double CorridorsStart = FPlatformTime::Seconds();
+	ON_SCOPE_EXIT { Map.Stats.CorridorsSeconds += FPlatformTime::Seconds() - CorridorsStart; };
+	if (Params.CorridorMode == ECorridorMode::AStar) Carver.Init(Params.Width, Params.Height);
+
+	const auto Center = [&Map](int32 RoomId) { return Map.Rooms[RoomId].GetCenter(); };
+	if (Params.Connectivity == ERoomConnectivity::MinimumSpanningTree)
+	{
+		RoomCenters.Reset();
+		for (int32 i = 0; i < Map.Rooms.Num(); ++i) RoomCenters.Add(Center(i));
+		Connectivity.Build(RoomCenters, Params.NeighborCount, Params.LoopFraction, RoomEdges);
+		for (int32 e = 0; e < RoomEdges.Num(); ++e)
+		{
+			if ((e & 15) == 0)
+			{
+				if (IsCancelled()) return false;
+				ReportProgress(0.4f + 0.4f * e / RoomEdges.Num());
+			}
+			CarveCorridor(Map, RoomCenters[RoomEdges[e].A], RoomCenters[RoomEdges[e].B], Params.CorridorMode);
+		}
+	}
+	else
+	{
+		// In sequence, then a few extra corridors
+		for (int32 i = 1; i < Map.Rooms.Num(); ++i)
 		{
-			FIntPoint Key(x, y);
-			const FCell* C = Map.Cells.Find(Key);
-			if (C && C->Type != ECellType::Empty) continue;
-			bool NearFloor = IsFloor(x + 1, y) || IsFloor(x - 1, y) || IsFloor(x, y + 1) || IsFloor(x, y - 1);
-			if (NearFloor)
+			if ((i & 15) == 0)
 			{
-				Map.Cells.Add(Key, FCell(x, y, ECellType::Wall));
+				if (IsCancelled()) return false;
+				ReportProgress(0.4f + 0.4f * i / Map.Rooms.Num());
 			}
+			CarveCorridor(Map, Center(i - 1), Center(i), Params.CorridorMode);
 		}
+		for (int32 k = 0; k < Params.ExtraCorridors && Map.Rooms.Num() > 1; ++k)
+		{
+			int32 I = Rand.RandRange(0, Map.Rooms.Num() - 1);
+			int32 J = Rand.RandRange(0, Map.Rooms.Num() - 1);
+			if (I == J) continue;
+			CarveCorridor(Map, Center(I), Center(J), Params.CorridorMode);
+		}
+	}
+	return true;
+}
 
-	return Map;
+bool UMapGenerator::PlaceRoomsParallel(const FProcGenParams& Params, int32 Seed, FMapData& Map, FProcGenJobState* Job)
+{
+	// Chunks must fit the largest room plus the one-tile gap kept along their max edges
+	const int32 ChunkSize = FMath::Max(Params.GenerationChunkSize, Params.MaxRoomSize + 2);
+	const int32 ChunksX = FMath::DivideAndRoundUp(Params.Width, ChunkSize);
+	const int32 ChunksY = FMath::DivideAndRoundUp(Params.Height, ChunkSize);
+	const int32 NumChunks = ChunksX * ChunksY;
+	const int64 MapArea = FMath::Max(int64(Params.Width) * Params.Height, int64(1));
+	ChunkRooms.SetNum(NumChunks, EAllowShrinking::No);
+
+	// Chunk-local rejection sampling: each chunk only sees its own rooms and its own random stream
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		TArray<FIntRect>& Rooms = ChunkRooms[Chunk];
+		Rooms.Reset();
+		if (Job && Job->IsCancelled()) return;
+
+		const FIntPoint Coord(Chunk % ChunksX, Chunk / ChunksX);
+		const int32 ChunkMinX = Coord.X * ChunkSize, ChunkMaxX = FMath::Min(ChunkMinX + ChunkSize, Params.Width);
+		const int32 ChunkMinY = Coord.Y * ChunkSize, ChunkMaxY = FMath::Min(ChunkMinY + ChunkSize, Params.Height);
+		const int32 Attempts = int32(int64(Params.RoomAttempts) * (ChunkMaxX - ChunkMinX) * (ChunkMaxY - ChunkMinY) / MapArea);
+
+		// Same map border as the serial layouts; room max edges stay one tile short of the next chunk
+		const int32 MinX = FMath::Max(ChunkMinX, 1), MaxX = FMath::Min(ChunkMaxX - 1, Params.Width - 2);
+		const int32 MinY = FMath::Max(ChunkMinY, 1), MaxY = FMath::Min(ChunkMaxY - 1, Params.Height - 2);
+		FProcRandom Rand(Seed, Coord, EProcGenPass::Rooms);
+		for (int32 i = 0; i < Attempts; ++i)
+		{
+			const int32 W = Rand.RandRange(Params.MinRoomSize, Params.MaxRoomSize);
+			const int32 H = Rand.RandRange(Params.MinRoomSize, Params.MaxRoomSize);
+			const int32 X = Rand.RandRange(MinX, MaxX - W);
+			const int32 Y = Rand.RandRange(MinY, MaxY - H);
+			if (X + W > MaxX || Y + H > MaxY) continue;
+
+			const FIntRect Padded(X - 1, Y - 1, X + W + 1, Y + H + 1);
+			const bool bOverlaps = Rooms.ContainsByPredicate([&Padded](const FIntRect& Other)
+			{
+				return Padded.Min.X < Other.Max.X && Other.Min.X < Padded.Max.X && Padded.Min.Y < Other.Max.Y && Other.Min.Y < Padded.Max.Y;
+			});
+			if (!bOverlaps) Rooms.Add(FIntRect(X, Y, X + W, Y + H));
+		}
+	});
+	if (Job && Job->IsCancelled()) return false;
+
+	// Room ids follow chunk order, not the order threads finished in
+	ChunkFirstRoom.SetNumUninitialized(NumChunks + 1, EAllowShrinking::No);
+	for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+	{
+		ChunkFirstRoom[Chunk] = Map.Rooms.Num();
+		for (const FIntRect& Rect : ChunkRooms[Chunk])
+		{
+			FRoom Rm; Rm.Bounds = Rect;
+			Map.Rooms.Add(Rm);
+			RoomIndex.Add(Rect);
+		}
+	}
+	ChunkFirstRoom[NumChunks] = Map.Rooms.Num();
+
+	// Stamping writes only inside each chunk. Chunked storage allocates on write, so it stays serial there.
+	const auto StampChunk = [this, &Map](int32 Chunk)
+	{
+		for (int32 RoomId = ChunkFirstRoom[Chunk]; RoomId < ChunkFirstRoom[Chunk + 1]; ++RoomId)
+		{
+			StampRoom(Map, Map.Rooms[RoomId].Bounds, RoomId);
+		}
+	};
+	if (Map.IsChunked())
+	{
+		for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk) StampChunk(Chunk);
+	}
+	else
+	{
+		ParallelFor(NumChunks, StampChunk);
+	}
+	if (Job) Job->SetProgress(0.4f);
+	return true;
+}
+
+IRoomLayoutStrategy& UMapGenerator::GetLayoutStrategy(ERoomLayout Layout)
+{
+	switch (Layout)
+	{
+	case ERoomLayout::PoissonDisk: return PoissonLayout;
+	case ERoomLayout::Bsp:         return BspLayout;
+	default:                       return RejectionLayout;
+	}
+}
+
+const FRoomLayoutStats& UMapGenerator::GetLayoutStats(ERoomLayout Layout) const
+{
+	return const_cast<UMapGenerator*>(this)->GetLayoutStrategy(Layout).GetStats();
+}
+
+void UMapGenerator::RecordLayoutStats(IRoomLayoutStrategy& Layout, const FMapData& Map, int32 Attempts, double Seconds)
+{
+	FRoomLayoutStats& Stats = Layout.GetMutableStats();
+	Stats.LastRooms = Map.Rooms.Num();
+	Stats.LastAttempts = Attempts;
+	Stats.LastSeconds = Seconds;
+	++Stats.Runs;
+	Stats.Rooms += Map.Rooms.Num();
+	Stats.Attempts += Attempts;
+	Stats.Seconds += Seconds;
+	for (const FRoom& Room : Map.Rooms) Stats.RoomCells += Room.Bounds.Area();
+
+	UE_LOG(LogTemp, Verbose, TEXT("ProcGen layout %s: %d rooms from %d attempts in %.2f ms"), Layout.GetName(), Map.Rooms.Num(), Attempts, Seconds * 1000.0);
 }
 
-void UMapGenerator::StampRoom(FMapData& Out, const FIntRect& Rect)
+bool UMapGenerator::TryAddRoom(FMapData& Map, const FIntRect& Rect)
 {
-	for (int32 y = Rect.Min.Y; y < Rect.Max.Y; ++y)
-		for (int32 x = Rect.Min.X; x < Rect.Max.X; ++x)
+	if (Rect.Min.X < 1 || Rect.Min.Y < 1 || IntersectsExisting(Rect)) return false;
+	FRoom Rm; Rm.Bounds = Rect;
+	const int32 RoomId = Map.Rooms.Add(Rm);
+	StampRoom(Map, Rect, RoomId);
+	RoomIndex.Add(Rect);
+	return true;
+}
+
+void UMapGenerator::Validate(const FProcGenParams& Params, FMapData& Map)
+{
+	Validator.Validate(WalkableBits, Map, Params.MinReachablePercent, Map.Validation);
+	if (Params.Validation != EMapValidation::Repair || Validator.GetStrandedCells().Num() == 0) return;
+
+	// Join every stranded region to the start room, then measure again
+	const FIntPoint Target = Map.Rooms[Map.Validation.StartRoom].GetCenter();
+	for (const FIntPoint& Cell : Validator.GetStrandedCells())
+	{
+		CarveCorridor(Map, Cell, Target, Params.CorridorMode);
+	}
+	const int32 RepairCorridors = Validator.GetStrandedCells().Num();
+	BuildOccupancyBits(Map, Params.bParallelChunks);
+	Validator.Validate(WalkableBits, Map, Params.MinReachablePercent, Map.Validation);
+	Map.Validation.RepairCorridors = RepairCorridors;
+}
+
+void UMapGenerator::BuildOccupancyBits(const FMapData& Map, bool bParallel)
+{
+	BuildCellBits(Map, WalkableBits, &OccupiedBits, bParallel);
+}
+
+void UMapGenerator::BuildCellBits(const FMapData& Map, FCellBitGrid& OutWalkable, FCellBitGrid* OutOccupied, bool bParallel)
+{
+	OutWalkable.Init(Map.GetWidth(), Map.GetHeight());
+	if (OutOccupied) OutOccupied->Init(Map.GetWidth(), Map.GetHeight());
+	if (bParallel && !Map.IsChunked())
+	{
+		// Each row only touches its own words
+		ParallelFor(Map.GetHeight(), [&Map, &OutWalkable, OutOccupied](int32 y)
+		{
+			const uint8* Row = Map.Grid.Types.GetData() + y * Map.Grid.Width;
+			for (int32 x = 0; x < Map.Grid.Width; ++x)
+			{
+				if (Row[x] == (uint8)ECellType::Empty) continue;
+				if (OutOccupied) OutOccupied->Set(x, y);
+				if (Row[x] == (uint8)ECellType::Floor || Row[x] == (uint8)ECellType::Door) OutWalkable.Set(x, y);
+			}
+		});
+		return;
+	}
+	Map.ForEachCell([&OutWalkable, OutOccupied](int32 x, int32 y, ECellType Type)
+	{
+		if (OutOccupied) OutOccupied->Set(x, y);
+		if (Type == ECellType::Floor || Type == ECellType::Door) OutWalkable.Set(x, y);
+	});
+}
+
+void UMapGenerator::BuildWallsAndEdges(FMapData& Map, bool bParallel)
+{
+	const int32 Height = Map.GetHeight();
+
+	// Walls = dilate(walkable) & ~occupied
+	FCellBitGrid::Dilate4(WalkableBits, NearWalkableBits);
+	for (int32 i = 0; i < NearWalkableBits.Words.Num(); ++i)
+	{
+		NearWalkableBits.Words[i] &= ~OccupiedBits.Words[i];
+	}
+
+	// Rows are independent; chunked storage still runs them in order since writes can allocate chunks
+	const int32 WordsPerRow = WalkableBits.WordsPerRow;
+	const auto ProcessRow = [this, &Map, WordsPerRow](int32 y)
+	{
+		const uint64* WallRow = NearWalkableBits.GetRow(y);
+		for (int32 w = 0; w < WordsPerRow; ++w)
 		{
-			Out.Cells.Add(FIntPoint(x, y), FCell(x, y, ECellType::Floor));
+			for (uint64 Bits = WallRow[w]; Bits; Bits &= Bits - 1)
+			{
+				Map.Set((w << 6) + (int32)FMath::CountTrailingZeros64(Bits), y, ECellType::Wall);
+			}
 		}
+	};
+	if (bParallel && !Map.IsChunked())
+	{
+		ParallelFor(Height, ProcessRow);
+	}
+	else
+	{
+		for (int32 y = 0; y < Height; ++y) ProcessRow(y);
+	}
+
+	SetOpenEdges(Map, WalkableBits, bParallel);
+}
+
+void UMapGenerator::RebuildOpenEdges(FMapData& Map, bool bParallel)
+{
+	FCellBitGrid Walkable;
+	BuildCellBits(Map, Walkable, nullptr, bParallel);
+	SetOpenEdges(Map, Walkable, bParallel);
 }
 
-void UMapGenerator::CarveCorridor(FMapData& Out, const FIntPoint& A, const FIntPoint& B)
+void UMapGenerator::SetOpenEdges(FMapData& Map, const FCellBitGrid& Walkable, bool bParallel)
 {
+	// Per row: for each walkable cell, which of its 4 neighbors are not walkable
+	const int32 Height = Map.GetHeight();
+	const int32 WordsPerRow = Walkable.WordsPerRow;
+	const auto ProcessRow = [&Map, &Walkable, Height, WordsPerRow](int32 y)
+	{
+		const uint64* Row = Walkable.GetRow(y);
+		const uint64* Below = y > 0 ? Walkable.GetRow(y - 1) : nullptr;
+		const uint64* Above = y + 1 < Height ? Walkable.GetRow(y + 1) : nullptr;
+		for (int32 w = 0; w < WordsPerRow; ++w)
+		{
+			uint64 Bits = Row[w];
+			if (!Bits) continue;
+
+			const uint64 OpenS = Bits & ~(Below ? Below[w] : 0);
+			const uint64 OpenN = Bits & ~(Above ? Above[w] : 0);
+			const uint64 OpenW = Bits & ~Walkable.WestOf(Row, w);
+			const uint64 OpenE = Bits & ~Walkable.EastOf(Row, w);
+			while (Bits)
+			{
+				const int32 Bit = (int32)FMath::CountTrailingZeros64(Bits);
+				const uint64 M = uint64(1) << Bit;
+				ECellFlags Edges = ECellFlags::None;
+				if (OpenS & M) Edges |= ECellFlags::OpenSouth;
+				if (OpenN & M) Edges |= ECellFlags::OpenNorth;
+				if (OpenW & M) Edges |= ECellFlags::OpenWest;
+				if (OpenE & M) Edges |= ECellFlags::OpenEast;
+
+				const int32 x = (w << 6) + Bit;
+				Map.SetFlags(x, y, (Map.GetFlags(x, y) & ~(uint8)ECellFlags::OpenEdges) | (uint8)Edges);
+				Bits &= Bits - 1;
+			}
+		}
+	};
+	if (bParallel && !Map.IsChunked())
+	{
+		ParallelFor(Height, ProcessRow);
+	}
+	else
+	{
+		for (int32 y = 0; y < Height; ++y) ProcessRow(y);
+	}
+}
+
+FIntRect UMapGenerator::RebuildWallsAndEdges(FMapData& Map, const FIntRect& ChangedRegion) const
+{
+	const FIntRect Affected(FMath::Max(ChangedRegion.Min.X - 1, 0), FMath::Max(ChangedRegion.Min.Y - 1, 0),
+		FMath::Min(ChangedRegion.Max.X + 1, Map.GetWidth()), FMath::Min(ChangedRegion.Max.Y + 1, Map.GetHeight()));
+
+	// Walls are derived data: drop them, then re-add the ones still next to a walkable cell.
+	// Walkable cells never change here, so the order of these two loops doesn't matter.
+	for (int32 y = Affected.Min.Y; y < Affected.Max.Y; ++y)
+		for (int32 x = Affected.Min.X; x < Affected.Max.X; ++x)
+		{
+			const ECellType Type = Map.Get(x, y);
+			if (Type == ECellType::Wall) Map.Set(x, y, ECellType::Empty);
+		}
+
+	for (int32 y = Affected.Min.Y; y < Affected.Max.Y; ++y)
+		for (int32 x = Affected.Min.X; x < Affected.Max.X; ++x)
+		{
+			if (Map.IsWalkable(x, y))
+			{
+				ECellFlags Edges = ECellFlags::None;
+				if (!Map.IsWalkable(x, y - 1)) Edges |= ECellFlags::OpenSouth;
+				if (!Map.IsWalkable(x, y + 1)) Edges |= ECellFlags::OpenNorth;
+				if (!Map.IsWalkable(x - 1, y)) Edges |= ECellFlags::OpenWest;
+				if (!Map.IsWalkable(x + 1, y)) Edges |= ECellFlags::OpenEast;
+				Map.SetFlags(x, y, (Map.GetFlags(x, y) & ~(uint8)ECellFlags::OpenEdges) | (uint8)Edges);
+			}
+			else
+			{
+				Map.SetFlags(x, y, Map.GetFlags(x, y) & ~(uint8)ECellFlags::OpenEdges);
+				if (Map.IsEmpty(x, y) && (Map.IsWalkable(x + 1, y) || Map.IsWalkable(x - 1, y) || Map.IsWalkable(x, y + 1) || Map.IsWalkable(x, y - 1)))
+				{
+					Map.Set(x, y, ECellType::Wall);
+				}
+			}
+		}
+	return Affected;
+}
+
+void UMapGenerator::StampRoom(FMapData& Out, const FIntRect& Rect, int32 RoomId)
+{
+	// Clip to the grid; rooms are sampled inside it but tiny maps can push them out
+	const int32 MinX = FMath::Max(Rect.Min.X, 0), MaxX = FMath::Min(Rect.Max.X, Out.GetWidth());
+	const int32 MinY = FMath::Max(Rect.Min.Y, 0), MaxY = FMath::Min(Rect.Max.Y, Out.GetHeight());
+	for (int32 y = MinY; y < MaxY; ++y)
+		for (int32 x = MinX; x < MaxX; ++x)
+		{
+			Out.Set(x, y, ECellType::Floor);
+			Out.SetRoomId(x, y, RoomId);
+		}
+}
+
+void UMapGenerator::CarveCorridor(FMapData& Out, const FIntPoint& A, const FIntPoint& B, ECorridorMode Mode)
+{
+	if (Mode == ECorridorMode::AStar && Carver.FindPath(Out, A, B, CorridorPath))
+	{
+		// Room cells on the route are already floor and keep their room id
+		for (const FIntPoint& Cell : CorridorPath)
+		{
+			if (Out.IsEmpty(Cell.X, Cell.Y)) Out.Set(Cell.X, Cell.Y, ECellType::Floor);
+		}
+		return;
+	}
+
 	// L-shaped (Manhattan). Randomize horizontal-first or vertical-first could be added.
 	int32 x = A.X, y = A.Y;
-	const auto Carve = [&Out](int32 CX, int32 CY) { Out.Cells.Add(FIntPoint(CX, CY), FCell(CX, CY, ECellType::Floor)); };
+	const auto Carve = [&Out](int32 CX, int32 CY) { Out.Set(CX, CY, ECellType::Floor); };
 
 	while (x != B.X) { x += (B.X > x) ? 1 : -1; Carve(x, y); }
 	while (y != B.Y) { y += (B.Y > y) ? 1 : -1; Carve(x, y); }
 }
 
-bool UMapGenerator::IntersectsExisting(const FMapData& Map, const FIntRect& Rect) const
+bool UMapGenerator::IntersectsExisting(const FIntRect& Rect) const
 {
-	// one tile padding
+	// one tile padding. During room placement the only occupied cells are earlier rooms,
+	// so testing against their rects gives the same answer as scanning the cells.
 	FIntRect Padded(Rect.Min.X - 1, Rect.Min.Y - 1, Rect.Max.X + 1, Rect.Max.Y + 1);
-	for (int32 y = Padded.Min.Y; y < Padded.Max.Y; ++y)
-		for (int32 x = Padded.Min.X; x < Padded.Max.X; ++x)
-		{
-			if (Map.Cells.Contains(FIntPoint(x, y))) return true;
-		}
-	return false;
+	return RoomIndex.Overlaps(Padded);
 }
@@ -2,17 +2,98 @@
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
 #include "ProcTypes.h"
+#include "RoomRectIndex.h"
+#include "CellBitGrid.h"
+#include "CorridorCarver.h"
+#include "RoomConnectivity.h"
+#include "MapValidator.h"
+#include "RoomLayouts.h"
+#include <atomic>
 #include "MapGenerator.generated.h"
 
+/**
+ * Cancellation flag and progress shared between a running generation and its owner.
+ * Safe to poke from any thread.
+ */
+struct FProcGenJobState
+{
+	void Cancel() { bCancelled.store(true, std::memory_order_relaxed); }
+	bool IsCancelled() const { return bCancelled.load(std::memory_order_relaxed); }
+
+	void SetProgress(float InProgress) { Progress.store(InProgress, std::memory_order_relaxed); }
+	float GetProgress() const { return Progress.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<bool> bCancelled{ false };
+	std::atomic<float> Progress{ 0.f };
+};
+
 UCLASS()
 class UMapGenerator : public UObject
 {
 	GENERATED_BODY()
 public:
+	/** Bump whenever the same Params and Seed produce a different map, so cached and baked maps are regenerated. */
+	static constexpr int32 GeneratorVersion = 2;
+
 	FMapData Run(const FProcGenParams& Params, int32 Seed);
 
+	/**
+	 * Same as above but generates into Out, reusing its grid and room allocations.
+	 * If Job is given, progress is reported to it and the run stops early once it is cancelled
+	 * (Out is then incomplete). A generator instance must only run one job at a time.
+	 */
+	void Run(const FProcGenParams& Params, int32 Seed, FMapData& Out, FProcGenJobState* Job = nullptr);
+
+	/**
+	 * Re-derives walls and open-edge flags after cells inside ChangedRegion were edited.
+	 * Only ChangedRegion plus a one-tile border can be affected; that rect (clipped to the map) is returned.
+	 */
+	FIntRect RebuildWallsAndEdges(FMapData& Map, const FIntRect& ChangedRegion) const;
+
+	/**
+	 * Derives the open-edge flags of the whole map with the bitboard pass Run uses, leaving cells as
+	 * they are. For maps whose walls are already in place, e.g. ones read back from a baked file.
+	 */
+	static void RebuildOpenEdges(FMapData& Map, bool bParallel);
+
+	/** Room layout strategy behind ERoomLayout. Each keeps timing and quality totals over the runs of this generator. */
+	IRoomLayoutStrategy& GetLayoutStrategy(ERoomLayout Layout);
+	const FRoomLayoutStats& GetLayoutStats(ERoomLayout Layout) const;
+
 private:
-	void StampRoom(FMapData& Out, const FIntRect& Rect);
-	void CarveCorridor(FMapData& Out, const FIntPoint& A, const FIntPoint& B);
-	bool IntersectsExisting(const FMapData& Map, const FIntRect& Rect) const;
+	/** Steps 1-2 of Run: rooms and corridors. False only if cancelled; no room fitting leaves Map.Rooms empty. */
+	bool BuildLayout(const FProcGenParams& Params, int32 Seed, FMapData& Map, FProcGenJobState* Job);
+	/** bParallelChunks room step: chunk-local placement and stamping under ParallelFor. False if cancelled. */
+	bool PlaceRoomsParallel(const FProcGenParams& Params, int32 Seed, FMapData& Map, FProcGenJobState* Job);
+	void RecordLayoutStats(IRoomLayoutStrategy& Layout, const FMapData& Map, int32 Attempts, double Seconds);
+	/** Adds the room unless it overlaps (with padding) a placed one. */
+	bool TryAddRoom(FMapData& Map, const FIntRect& Rect);
+	/** Fills Map.Validation from WalkableBits; in Repair mode also carves stranded regions back in. */
+	void Validate(const FProcGenParams& Params, FMapData& Map);
+	void StampRoom(FMapData& Out, const FIntRect& Rect, int32 RoomId);
+	void CarveCorridor(FMapData& Out, const FIntPoint& A, const FIntPoint& B, ECorridorMode Mode);
+	bool IntersectsExisting(const FIntRect& Rect) const;
+	void BuildOccupancyBits(const FMapData& Map, bool bParallel); // WalkableBits/OccupiedBits from the current cells
+	void BuildWallsAndEdges(FMapData& Map, bool bParallel);       // needs BuildOccupancyBits first
+	static void BuildCellBits(const FMapData& Map, FCellBitGrid& OutWalkable, FCellBitGrid* OutOccupied, bool bParallel);
+	static void SetOpenEdges(FMapData& Map, const FCellBitGrid& Walkable, bool bParallel);
+
+	FRoomRectIndex RoomIndex; // placed rooms, reused across runs
+	TArray<TArray<FIntRect>> ChunkRooms; // parallel mode: rooms per generation chunk
+	TArray<int32> ChunkFirstRoom;        // parallel mode: first room id per chunk, plus one past the end
+	FRejectionRoomLayout RejectionLayout;
+	FPoissonDiskRoomLayout PoissonLayout;
+	FBspRoomLayout BspLayout;
+	FCorridorCarver Carver;   // A* buffers, reused across corridors and runs
+	TArray<FIntPoint> CorridorPath;
+	FRoomConnectivity Connectivity; // kNN/MST scratch, reused across runs
+	TArray<FIntPoint> RoomCenters;
+	TArray<FRoomEdge> RoomEdges;
+	FMapValidator Validator;
+
+	// Bitboards for the walls pass, reused across runs
+	FCellBitGrid WalkableBits;
+	FCellBitGrid OccupiedBits;
+	FCellBitGrid NearWalkableBits;
 };
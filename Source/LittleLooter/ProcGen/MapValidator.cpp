@@ -0,0 +1,137 @@
+#include "MapValidator.h"
+#include "Async/ParallelFor.h"
+
+static constexpr int32 RowsPerTask = 64;
+
+void FMapValidator::FindRuns(const FCellBitGrid& Walkable)
+{
+	const int32 Height = Walkable.Height;
+	const int32 NumTasks = FMath::DivideAndRoundUp(Height, RowsPerTask);
+	RowRunStart.SetNumUninitialized(Height + 1, EAllowShrinking::No);
+	RowRunStart[0] = 0;
+
+	// A run starts on a walkable cell whose west neighbor isn't, and ends on one whose east neighbor isn't
+	ParallelFor(NumTasks, [&](int32 Task)
+	{
+		const int32 EndY = FMath::Min((Task + 1) * RowsPerTask, Height);
+		for (int32 y = Task * RowsPerTask; y < EndY; ++y)
+		{
+			const uint64* Row = Walkable.GetRow(y);
+			int32 Count = 0;
+			for (int32 w = 0; w < Walkable.WordsPerRow; ++w)
+			{
+				Count += (int32)FMath::CountBits(Row[w] & ~Walkable.WestOf(Row, w));
+			}
+			RowRunStart[y + 1] = Count;
+		}
+	});
+	for (int32 y = 0; y < Height; ++y) RowRunStart[y + 1] += RowRunStart[y];
+
+	// Starts and ends come out in the same order, so the k-th start pairs with the k-th end
+	Runs.SetNumUninitialized(RowRunStart[Height], EAllowShrinking::No);
+	ParallelFor(NumTasks, [&](int32 Task)
+	{
+		const int32 EndY = FMath::Min((Task + 1) * RowsPerTask, Height);
+		for (int32 y = Task * RowsPerTask; y < EndY; ++y)
+		{
+			const uint64* Row = Walkable.GetRow(y);
+			int32 NextStart = RowRunStart[y], NextEnd = RowRunStart[y];
+			for (int32 w = 0; w < Walkable.WordsPerRow; ++w)
+			{
+				uint64 Starts = Row[w] & ~Walkable.WestOf(Row, w);
+				uint64 Ends = Row[w] & ~Walkable.EastOf(Row, w);
+				for (; Starts; Starts &= Starts - 1) Runs[NextStart++].Start = (w << 6) + (int32)FMath::CountTrailingZeros64(Starts);
+				for (; Ends; Ends &= Ends - 1) Runs[NextEnd++].End = (w << 6) + (int32)FMath::CountTrailingZeros64(Ends);
+			}
+		}
+	});
+}
+
+int32 FMapValidator::FindRun(int32 X, int32 Y) const
+{
+	if (Y < 0 || Y + 1 >= RowRunStart.Num()) return INDEX_NONE;
+	int32 Lo = RowRunStart[Y], Hi = RowRunStart[Y + 1];
+	while (Lo < Hi)
+	{
+		const int32 Mid = (Lo + Hi) / 2;
+		if (Runs[Mid].End < X) Lo = Mid + 1;
+		else Hi = Mid;
+	}
+	return (Lo < RowRunStart[Y + 1] && Runs[Lo].Start <= X) ? Lo : INDEX_NONE;
+}
+
+void FMapValidator::Validate(const FCellBitGrid& Walkable, const FMapData& Map, float MinReachablePercent, FMapValidation& Out)
+{
+	FindRuns(Walkable);
+
+	// Merge: union every run with the runs it overlaps in the row below (two-pointer sweep)
+	Sets.Init(Runs.Num());
+	for (int32 y = 1; y < Walkable.Height; ++y)
+	{
+		int32 Below = RowRunStart[y - 1];
+		const int32 BelowEnd = RowRunStart[y];
+		for (int32 r = RowRunStart[y]; r < RowRunStart[y + 1] && Below < BelowEnd; )
+		{
+			if (Runs[Below].End >= Runs[r].Start && Runs[r].End >= Runs[Below].Start) Sets.Union(Below, r);
+			if (Runs[Below].End < Runs[r].End) ++Below;
+			else ++r;
+		}
+	}
+
+	ComponentCells.Init(0, Runs.Num());
+	int32 WalkableCells = 0;
+	for (int32 r = 0; r < Runs.Num(); ++r)
+	{
+		const int32 Length = Runs[r].End - Runs[r].Start + 1;
+		ComponentCells[Sets.Find(r)] += Length;
+		WalkableCells += Length;
+	}
+
+	Out.bValidated = true;
+	Out.WalkableCells = WalkableCells;
+	Out.NumComponents = Sets.GetNumSets();
+	Out.StartRoom = Out.GoalRoom = INDEX_NONE;
+	Out.bStartReachesGoal = false;
+	Out.ReachablePercent = 0.f;
+	StrandedCells.Reset();
+
+	if (Map.Rooms.Num() > 0)
+	{
+		const FIntPoint StartCenter = Map.Rooms[0].GetCenter();
+		int32 Farthest = -1;
+		for (int32 i = 0; i < Map.Rooms.Num(); ++i)
+		{
+			const FIntPoint Center = Map.Rooms[i].GetCenter();
+			const int32 Distance = FMath::Abs(Center.X - StartCenter.X) + FMath::Abs(Center.Y - StartCenter.Y);
+			if (Distance > Farthest)
+			{
+				Farthest = Distance;
+				Out.GoalRoom = i;
+			}
+		}
+		Out.StartRoom = 0;
+
+		const FIntPoint GoalCenter = Map.Rooms[Out.GoalRoom].GetCenter();
+		const int32 StartRun = FindRun(StartCenter.X, StartCenter.Y);
+		const int32 GoalRun = FindRun(GoalCenter.X, GoalCenter.Y);
+		if (StartRun != INDEX_NONE)
+		{
+			const int32 StartRoot = Sets.Find(StartRun);
+			Out.bStartReachesGoal = GoalRun != INDEX_NONE && Sets.Find(GoalRun) == StartRoot;
+			Out.ReachablePercent = WalkableCells > 0 ? 100.f * ComponentCells[StartRoot] / WalkableCells : 0.f;
+
+			// First run of every other region, in row-major order. ComponentCells doubles as the seen mark.
+			for (int32 y = 0; y < Walkable.Height; ++y)
+			{
+				for (int32 r = RowRunStart[y]; r < RowRunStart[y + 1]; ++r)
+				{
+					const int32 Root = Sets.Find(r);
+					if (Root == StartRoot || ComponentCells[Root] < 0) continue;
+					ComponentCells[Root] = -1;
+					StrandedCells.Add(FIntPoint(Runs[r].Start, y));
+				}
+			}
+		}
+	}
+	Out.bPassed = Out.bStartReachesGoal && Out.ReachablePercent >= MinReachablePercent;
+}
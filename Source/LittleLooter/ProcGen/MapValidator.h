@@ -0,0 +1,39 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+#include "CellBitGrid.h"
+#include "UnionFind.h"
+
+/**
+ * Labels 4-connected walkable regions and checks the map's connectivity targets.
+ *
+ * Works on horizontal runs of walkable cells rather than on cells: rows are split into runs in
+ * parallel straight from the walkable bitboard, then a serial merge unions runs that overlap
+ * a run in the row below. Cost is about W*H/64 words plus the number of runs, so it is cheap
+ * enough to run after every generation. Buffers are reused across calls; one call at a time.
+ */
+struct FMapValidator
+{
+	/** Fills Out from the walkable cells in Walkable and the rooms in Map. */
+	void Validate(const FCellBitGrid& Walkable, const FMapData& Map, float MinReachablePercent, FMapValidation& Out);
+
+	/** One cell of every region not connected to the start room, from the last Validate. */
+	const TArray<FIntPoint>& GetStrandedCells() const { return StrandedCells; }
+
+private:
+	/** Run of walkable cells in one row, X in [Start, End]. */
+	struct FRun
+	{
+		int32 Start;
+		int32 End;
+	};
+
+	void FindRuns(const FCellBitGrid& Walkable);
+	int32 FindRun(int32 X, int32 Y) const;
+
+	TArray<int32> RowRunStart; // per row offset into Runs, Height+1 entries
+	TArray<FRun> Runs;
+	TArray<int32> ComponentCells; // walkable cells per union-find root
+	TArray<FIntPoint> StrandedCells;
+	FUnionFind Sets;
+};
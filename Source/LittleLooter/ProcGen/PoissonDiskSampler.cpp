@@ -0,0 +1,70 @@
+#include "PoissonDiskSampler.h"
+
+void FPoissonDiskSampler::Init(const FIntRect& InArea, float InRadius)
+{
+	Area = InArea;
+	Radius = FMath::Max(InRadius, 1.f);
+	CellSize = Radius / UE_SQRT_2;
+	GridWidth = FMath::Max(FMath::CeilToInt(FMath::Max(Area.Width(), 0) / CellSize), 1);
+	GridHeight = FMath::Max(FMath::CeilToInt(FMath::Max(Area.Height(), 0) / CellSize), 1);
+	Grid.Init(INDEX_NONE, GridWidth * GridHeight);
+	Points.Reset();
+	Active.Reset();
+	NumCandidates = 0;
+}
+
+bool FPoissonDiskSampler::IsFarEnough(const FVector2D& P) const
+{
+	// Cells are Radius/sqrt(2) wide, so anything closer than Radius is within two cells
+	const int32 CX = CellX(P.X), CY = CellY(P.Y);
+	for (int32 y = FMath::Max(CY - 2, 0); y <= FMath::Min(CY + 2, GridHeight - 1); ++y)
+	{
+		for (int32 x = FMath::Max(CX - 2, 0); x <= FMath::Min(CX + 2, GridWidth - 1); ++x)
+		{
+			const int32 Other = Grid[y * GridWidth + x];
+			if (Other != INDEX_NONE && FVector2D::DistSquared(P, Points[Other]) < Radius * Radius) return false;
+		}
+	}
+	return true;
+}
+
+void FPoissonDiskSampler::Add(const FVector2D& P)
+{
+	const int32 Index = Points.Add(P);
+	Grid[CellY(P.Y) * GridWidth + CellX(P.X)] = Index;
+	Active.Add(Index);
+}
+
+bool FPoissonDiskSampler::Next(FRandomStream& Rand, FIntPoint& OutPoint)
+{
+	if (Area.Width() <= 0 || Area.Height() <= 0) return false;
+
+	if (Points.Num() == 0)
+	{
+		const FVector2D First(Rand.FRandRange(Area.Min.X, Area.Max.X), Rand.FRandRange(Area.Min.Y, Area.Max.Y));
+		Add(First);
+		OutPoint = FIntPoint(FMath::FloorToInt(First.X), FMath::FloorToInt(First.Y));
+		return true;
+	}
+
+	while (Active.Num() > 0)
+	{
+		const int32 Slot = Rand.RandRange(0, Active.Num() - 1);
+		const FVector2D Origin = Points[Active[Slot]];
+		for (int32 k = 0; k < CandidatesPerPoint; ++k)
+		{
+			++NumCandidates;
+			const float Angle = Rand.FRandRange(0.f, 2.f * UE_PI);
+			const float Distance = Rand.FRandRange(Radius, 2.f * Radius);
+			const FVector2D P(Origin.X + Distance * FMath::Cos(Angle), Origin.Y + Distance * FMath::Sin(Angle));
+			if (P.X < Area.Min.X || P.Y < Area.Min.Y || P.X >= Area.Max.X || P.Y >= Area.Max.Y) continue;
+			if (!IsFarEnough(P)) continue;
+
+			Add(P);
+			OutPoint = FIntPoint(FMath::FloorToInt(P.X), FMath::FloorToInt(P.Y));
+			return true;
+		}
+		Active.RemoveAtSwap(Slot, EAllowShrinking::No);
+	}
+	return false;
+}
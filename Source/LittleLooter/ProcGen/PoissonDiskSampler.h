@@ -0,0 +1,41 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Bridson's Poisson-disk sampling over a rectangle. Every point is at least Radius from all
+ * earlier ones, and new points are only tried in the annulus around points that still have free
+ * space nearby, so each try lands where it can succeed. A background grid of Radius/sqrt(2) cells
+ * holds at most one point each, which makes the distance test a fixed 5x5 cell lookup.
+ *
+ * Deterministic for a given FRandomStream state. Buffers are reused across Init calls.
+ */
+struct FPoissonDiskSampler
+{
+	int32 CandidatesPerPoint = 30; // Bridson's k: tries around an active point before it is retired
+
+	/** Starts a new point set inside Area ([Min, Max)). */
+	void Init(const FIntRect& InArea, float InRadius);
+
+	/** Next point, grown from the existing ones. False once the area is saturated. */
+	bool Next(FRandomStream& Rand, FIntPoint& OutPoint);
+
+	int32 Num() const { return Points.Num(); }
+	int32 GetNumCandidates() const { return NumCandidates; } // total tries so far, for tuning
+
+private:
+	bool IsFarEnough(const FVector2D& P) const;
+	void Add(const FVector2D& P);
+
+	FORCEINLINE int32 CellX(float X) const { return FMath::Clamp((int32)((X - Area.Min.X) / CellSize), 0, GridWidth - 1); }
+	FORCEINLINE int32 CellY(float Y) const { return FMath::Clamp((int32)((Y - Area.Min.Y) / CellSize), 0, GridHeight - 1); }
+
+	FIntRect Area;
+	float Radius = 1.f;
+	float CellSize = 1.f;
+	int32 GridWidth = 0;
+	int32 GridHeight = 0;
+	TArray<int32> Grid; // point index per background cell, INDEX_NONE when empty
+	TArray<FVector2D> Points;
+	TArray<int32> Active; // points that may still have free space around them
+	int32 NumCandidates = 0;
+};
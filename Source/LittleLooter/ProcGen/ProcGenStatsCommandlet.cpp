@@ -0,0 +1,188 @@
+#include "ProcGenStatsCommandlet.h"
+#include "ProcMapManager.h"
+#include "MapGenerator.h"
+#include "ProcInstanceBuilder.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Tasks/Task.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+#include <atomic>
+
+namespace ProcGenStats
+{
+	struct FRow
+	{
+		int32 Seed = 0;
+		int32 Rooms = 0;
+		int32 FloorCells = 0;
+		int32 WallCells = 0;
+		int32 CorridorCells = 0; // walkable cells outside every room
+		float ReachablePercent = 0.f;
+		int32 Components = 0;
+		bool bPassed = false;
+		int32 Attempts = 0;
+		int32 FloorInstances = 0;
+		int32 WallInstances = 0;
+		double GenerateMs = 0.0;
+		double InstancesMs = 0.0;
+	};
+
+	void Measure(const FMapData& Map, const FProcInstanceBatch& Instances, FRow& Row)
+	{
+		Row.Rooms = Map.Rooms.Num();
+		Map.ForEachCell([&Map, &Row](int32 X, int32 Y, ECellType Type)
+		{
+			if (Type == ECellType::Wall)
+			{
+				++Row.WallCells;
+				return;
+			}
+			if (Type == ECellType::Floor) ++Row.FloorCells;
+			if (Map.GetRoomId(X, Y) == INDEX_NONE) ++Row.CorridorCells;
+		});
+		Row.ReachablePercent = Map.Validation.ReachablePercent;
+		Row.Components = Map.Validation.NumComponents;
+		Row.bPassed = Map.Validation.bPassed;
+		Row.Attempts = Map.Validation.Attempts;
+		Row.FloorInstances = Instances.Floors.Num();
+		Row.WallInstances = Instances.Walls.Num();
+		Row.GenerateMs = Map.Stats.TotalSeconds * 1000.0;
+		Row.InstancesMs = Instances.BuildSeconds * 1000.0;
+	}
+
+	const TCHAR* CsvHeader = TEXT("Seed,Rooms,FloorCells,WallCells,CorridorCells,ReachablePercent,Components,Passed,Attempts,FloorInstances,WallInstances,GenerateMs,InstancesMs\n");
+
+	FString ToCsv(const FRow& R)
+	{
+		return FString::Printf(TEXT("%d,%d,%d,%d,%d,%.2f,%d,%d,%d,%d,%d,%.3f,%.3f\n"), R.Seed, R.Rooms, R.FloorCells, R.WallCells, R.CorridorCells,
+			R.ReachablePercent, R.Components, R.bPassed ? 1 : 0, R.Attempts, R.FloorInstances, R.WallInstances, R.GenerateMs, R.InstancesMs);
+	}
+
+	FString ToJson(const FRow& R)
+	{
+		return FString::Printf(TEXT("{\"seed\":%d,\"rooms\":%d,\"floorCells\":%d,\"wallCells\":%d,\"corridorCells\":%d,\"reachablePercent\":%.2f,")
+			TEXT("\"components\":%d,\"passed\":%s,\"attempts\":%d,\"floorInstances\":%d,\"wallInstances\":%d,\"generateMs\":%.3f,\"instancesMs\":%.3f}\n"),
+			R.Seed, R.Rooms, R.FloorCells, R.WallCells, R.CorridorCells, R.ReachablePercent, R.Components, R.bPassed ? TEXT("true") : TEXT("false"),
+			R.Attempts, R.FloorInstances, R.WallInstances, R.GenerateMs, R.InstancesMs);
+	}
+
+	/** Params and tile settings of the first manager in MapName. False if the level can't be loaded. */
+	bool LoadManagerParams(const FString& MapName, FProcGenParams& OutParams, FProcInstanceSettings& OutSettings)
+	{
+		UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+		const UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+		if (!World || !World->PersistentLevel) return false;
+		for (AActor* Actor : World->PersistentLevel->Actors)
+		{
+			if (const AProcMapManager* Manager = Cast<AProcMapManager>(Actor))
+			{
+				OutParams = Manager->MakeGenParams();
+				OutSettings = Manager->MakeInstanceSettings();
+				UE_LOG(LogTemp, Display, TEXT("ProcGenStats: params from %s in %s"), *Manager->GetName(), *MapName);
+				break;
+			}
+		}
+		return true;
+	}
+}
+
+UProcGenStatsCommandlet::UProcGenStatsCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UProcGenStatsCommandlet::Main(const FString& Params)
+{
+	using namespace ProcGenStats;
+
+	int32 Count = 1000, FirstSeed = 1;
+	int32 NumWorkers = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+	FParse::Value(*Params, TEXT("Count="), Count);
+	FParse::Value(*Params, TEXT("FirstSeed="), FirstSeed);
+	FParse::Value(*Params, TEXT("Threads="), NumWorkers);
+	Count = FMath::Max(Count, 0);
+	NumWorkers = FMath::Clamp(NumWorkers, 1, FMath::Max(Count, 1));
+
+	FProcGenParams GenParams;
+	FProcInstanceSettings Settings;
+	FString MapName;
+	if (FParse::Value(*Params, TEXT("Map="), MapName) && !LoadManagerParams(MapName, GenParams, Settings))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ProcGenStats: can't load level %s"), *MapName);
+		return 1;
+	}
+	FString ParamsText;
+	if (FParse::Value(*Params, TEXT("Params="), ParamsText, /*bShouldStopOnSeparator*/ false)
+		&& !FProcGenParams::StaticStruct()->ImportText(*ParamsText, &GenParams, nullptr, PPF_None, GWarn, TEXT("FProcGenParams")))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ProcGenStats: can't parse -Params=%s"), *ParamsText);
+		return 1;
+	}
+
+	FString OutPath = FPaths::ProjectSavedDir() / TEXT("ProcGenStats") / FString::Printf(TEXT("Stats_%s.csv"), *FDateTime::Now().ToString());
+	if (FParse::Value(*Params, TEXT("Out="), OutPath) && FPaths::IsRelative(OutPath)) OutPath = FPaths::ProjectDir() / OutPath;
+	const bool bJson = OutPath.EndsWith(TEXT(".jsonl"));
+
+	FString ParamsDesc;
+	FProcGenParams::StaticStruct()->ExportText(ParamsDesc, &GenParams, nullptr, nullptr, PPF_None, nullptr);
+	UE_LOG(LogTemp, Display, TEXT("ProcGenStats: %d seeds from %d on %d workers, params %s"), Count, FirstSeed, NumWorkers, *ParamsDesc);
+
+	// One generator per worker; workers pull the next seed until the batch is done
+	TArray<TStrongObjectPtr<UMapGenerator>> Generators;
+	for (int32 w = 0; w < NumWorkers; ++w) Generators.Emplace(NewObject<UMapGenerator>());
+
+	TArray<FRow> Rows;
+	Rows.SetNum(Count);
+	std::atomic<int32> NextIndex{ 0 };
+	std::atomic<int32> NumDone{ 0 };
+	const double Start = FPlatformTime::Seconds();
+	TArray<UE::Tasks::FTask> Tasks;
+	for (int32 w = 0; w < NumWorkers; ++w)
+	{
+		Tasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [&, w]()
+		{
+			FMapData Map;
+			FProcInstanceBatch Instances;
+			for (int32 i = NextIndex++; i < Count; i = NextIndex++)
+			{
+				FRow& Row = Rows[i];
+				Row.Seed = FirstSeed + i;
+				Generators[w]->Run(GenParams, Row.Seed, Map);
+				FProcInstanceBuilder::Build(Map, Settings, Instances);
+				Measure(Map, Instances, Row);
+				++NumDone;
+			}
+		}));
+	}
+
+	// Progress from this thread while the workers run
+	for (int32 Logged = 0; !UE::Tasks::Wait(Tasks, FTimespan::FromSeconds(5.0)); )
+	{
+		const int32 Done = NumDone.load();
+		if (Done == Logged) continue;
+		Logged = Done;
+		UE_LOG(LogTemp, Display, TEXT("ProcGenStats: %d / %d"), Done, Count);
+	}
+	const double Seconds = FPlatformTime::Seconds() - Start;
+
+	FString Out;
+	Out.Reserve(Count * 128);
+	if (!bJson) Out += CsvHeader;
+	for (const FRow& Row : Rows) Out += bJson ? ToJson(Row) : ToCsv(Row);
+	if (!FFileHelper::SaveStringToFile(Out, *OutPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ProcGenStats: failed to write %s"), *OutPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("ProcGenStats: %d seeds in %.1f s (%.2f ms/seed over %d workers) -> %s"),
+		Count, Seconds, Count > 0 ? Seconds * 1000.0 / Count : 0.0, NumWorkers, *FPaths::ConvertRelativePathToFull(OutPath));
+	return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ProcGenStatsCommandlet.generated.h"
+
+/**
+ * Generates a batch of seeds on all cores and writes one row of stats per seed, for tuning FProcGenParams:
+ *   UnrealEditor-Cmd LittleLooter.uproject -run=ProcGenStats -nullrhi [-Count=5000] [-FirstSeed=1] [-Threads=N]
+ *     [-Map=/Game/Levels/ProcGenMap] [-Params="(Width=200,Height=200,Layout=Bsp)"] [-Out=Saved/ProcGenStats/Run.jsonl]
+ * Params start from the first AProcMapManager in -Map (defaults if none), then -Params overrides fields.
+ * Output is CSV, or JSON lines when -Out ends in .jsonl; a relative -Out is under the project directory.
+ */
+UCLASS()
+class UProcGenStatsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UProcGenStatsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,203 @@
+#include "ProcGridNavMesh.h"
+#include "ProcMapManager.h"
+
+AProcGridNavMesh::AProcGridNavMesh(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	RecastFindPath = FindPathImplementation;
+	RecastTestPath = TestPathImplementation;
+	RecastRaycast = RaycastImplementation;
+	FindPathImplementation = FindGridPath;
+	FindHierarchicalPathImplementation = FindGridPath;
+	TestPathImplementation = TestGridPath;
+	TestHierarchicalPathImplementation = TestGridPath;
+	RaycastImplementation = RaycastGrid;
+}
+
+void AProcGridNavMesh::AddGridManager(AProcMapManager* Manager)
+{
+	FScopeLock Lock(&ManagersLock);
+	GridManagers.RemoveAllSwap([](const TWeakObjectPtr<AProcMapManager>& Ptr) { return !Ptr.IsValid(); });
+	GridManagers.AddUnique(Manager);
+}
+
+void AProcGridNavMesh::RemoveGridManager(AProcMapManager* Manager)
+{
+	FScopeLock Lock(&ManagersLock);
+	GridManagers.RemoveSwap(Manager);
+}
+
+AProcMapManager* AProcGridNavMesh::FindGridManager(const FVector& Location) const
+{
+	FScopeLock Lock(&ManagersLock);
+	for (const TWeakObjectPtr<AProcMapManager>& Ptr : GridManagers)
+	{
+		AProcMapManager* Manager = Ptr.Get();
+		if (Manager && Manager->ContainsGridNavPoint(Location)) return Manager;
+	}
+	return nullptr;
+}
+
+FPathFindingResult AProcGridNavMesh::FindGridPath(const FNavAgentProperties& AgentProperties, const FPathFindingQuery& Query)
+{
+	const AProcGridNavMesh* Self = Cast<const AProcGridNavMesh>(Query.NavData.Get());
+	if (!Self) return FPathFindingResult(ENavigationQueryResult::Error);
+	const AProcMapManager* Manager = Self->FindGridManager(Query.StartLocation);
+	if (!Manager) return Self->RecastFindPath(AgentProperties, Query);
+
+	// Same path object handling as Recast: refill the caller's path on repaths
+	FPathFindingResult Result(ENavigationQueryResult::Error);
+	FNavigationPath* NavPath = Query.PathInstanceToFill.Get();
+	if (NavPath)
+	{
+		Result.Path = Query.PathInstanceToFill;
+		NavPath->ResetForRepath();
+	}
+	else
+	{
+		Result.Path = Self->CreatePathInstance<FNavigationPath>(Query);
+		NavPath = Result.Path.Get();
+	}
+
+	TArray<FVector> Points;
+	if (!Manager->FindGridNavPath(Query.StartLocation, Query.EndLocation, Points))
+	{
+		Result.Result = ENavigationQueryResult::Fail;
+		return Result;
+	}
+	TArray<FNavPathPoint>& PathPoints = NavPath->GetPathPoints();
+	PathPoints.Reserve(Points.Num());
+	for (const FVector& Point : Points)
+	{
+		PathPoints.Add(FNavPathPoint(Point));
+	}
+	NavPath->MarkReady();
+	Result.Result = ENavigationQueryResult::Success;
+	return Result;
+}
+
+bool AProcGridNavMesh::TestGridPath(const FNavAgentProperties& AgentProperties, const FPathFindingQuery& Query, int32* NumVisitedNodes)
+{
+	const AProcGridNavMesh* Self = Cast<const AProcGridNavMesh>(Query.NavData.Get());
+	if (!Self) return false;
+	const AProcMapManager* Manager = Self->FindGridManager(Query.StartLocation);
+	if (!Manager) return Self->RecastTestPath(AgentProperties, Query, NumVisitedNodes);
+
+	if (NumVisitedNodes) *NumVisitedNodes = 0;
+	TArray<FVector> Points;
+	return Manager->FindGridNavPath(Query.StartLocation, Query.EndLocation, Points);
+}
+
+bool AProcGridNavMesh::RaycastGrid(const ANavigationData* NavData, const FVector& RayStart, const FVector& RayEnd, FVector& HitLocation, FNavigationRaycastAdditionalResults* AdditionalResults, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier)
+{
+	const AProcGridNavMesh* Self = Cast<const AProcGridNavMesh>(NavData);
+	if (!Self) return false;
+	const AProcMapManager* Manager = Self->FindGridManager(RayStart);
+	if (!Manager) return Self->RecastRaycast(NavData, RayStart, RayEnd, HitLocation, AdditionalResults, QueryFilter, Querier);
+
+	return Manager->RaycastGridNav(RayStart, RayEnd, HitLocation);
+}
+
+bool AProcGridNavMesh::ProjectPoint(const FVector& Point, FNavLocation& OutLocation, const FVector& Extent, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+	const AProcMapManager* Manager = FindGridManager(Point);
+	if (!Manager) return Super::ProjectPoint(Point, OutLocation, Extent, Filter, Querier);
+
+	FVector Location;
+	if (!Manager->ProjectToGridNav(Point, Extent, Location)) return false;
+	OutLocation = FNavLocation(Location);
+	return true;
+}
+
+void AProcGridNavMesh::BatchProjectPoints(TArray<FNavigationProjectionWork>& Workload, const FVector& Extent, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+	{
+		FScopeLock Lock(&ManagersLock);
+		if (GridManagers.Num() == 0)
+		{
+			Super::BatchProjectPoints(Workload, Extent, Filter, Querier);
+			return;
+		}
+	}
+	for (FNavigationProjectionWork& Work : Workload)
+	{
+		Work.bResult = ProjectPoint(Work.Point, Work.OutLocation, Extent, Filter, Querier);
+	}
+}
+
+FNavLocation AProcGridNavMesh::GetRandomPoint(FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+	TArray<AProcMapManager*, TInlineAllocator<4>> Managers;
+	{
+		FScopeLock Lock(&ManagersLock);
+		for (const TWeakObjectPtr<AProcMapManager>& Ptr : GridManagers)
+		{
+			if (AProcMapManager* Manager = Ptr.Get()) Managers.Add(Manager);
+		}
+	}
+	FVector Location;
+	for (const AProcMapManager* Manager : Managers)
+	{
+		if (Manager->GetRandomGridNavPoint(FVector::ZeroVector, 0.f, Location)) return FNavLocation(Location);
+	}
+	return Super::GetRandomPoint(Filter, Querier);
+}
+
+bool AProcGridNavMesh::GetRandomReachablePointInRadius(const FVector& Origin, float Radius, FNavLocation& OutResult, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+	const AProcMapManager* Manager = FindGridManager(Origin);
+	if (!Manager) return Super::GetRandomReachablePointInRadius(Origin, Radius, OutResult, Filter, Querier);
+
+	FVector Location;
+	if (!Manager->GetRandomGridNavPoint(Origin, Radius, Location)) return false;
+	OutResult = FNavLocation(Location);
+	return true;
+}
+
+bool AProcGridNavMesh::GetRandomPointInNavigableRadius(const FVector& Origin, float Radius, FNavLocation& OutResult, FSharedConstNavQueryFilter Filter, const UObject* Querier) const
+{
+	// Grid points are only returned with a path from Origin: stricter than navigable, never looser
+	const AProcMapManager* Manager = FindGridManager(Origin);
+	if (!Manager) return Super::GetRandomPointInNavigableRadius(Origin, Radius, OutResult, Filter, Querier);
+
+	FVector Location;
+	if (!Manager->GetRandomGridNavPoint(Origin, Radius, Location)) return false;
+	OutResult = FNavLocation(Location);
+	return true;
+}
+
+ENavigationQueryResult::Type AProcGridNavMesh::CalcGridPathLength(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength) const
+{
+	const AProcMapManager* Manager = FindGridManager(PathStart);
+	if (!Manager) return ENavigationQueryResult::Invalid;
+
+	TArray<FVector> Points;
+	if (!Manager->FindGridNavPath(PathStart, PathEnd, Points)) return ENavigationQueryResult::Fail;
+	OutPathLength = 0.0;
+	for (int32 i = 1; i < Points.Num(); ++i)
+	{
+		OutPathLength += FVector::Dist(Points[i - 1], Points[i]);
+	}
+	return ENavigationQueryResult::Success;
+}
+
+ENavigationQueryResult::Type AProcGridNavMesh::CalcPathCost(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathCost, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier) const
+{
+	// Grid polys all have the default area, whose cost per unit is 1
+	const ENavigationQueryResult::Type Result = CalcGridPathLength(PathStart, PathEnd, OutPathCost);
+	return Result != ENavigationQueryResult::Invalid ? Result : Super::CalcPathCost(PathStart, PathEnd, OutPathCost, QueryFilter, Querier);
+}
+
+ENavigationQueryResult::Type AProcGridNavMesh::CalcPathLength(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier) const
+{
+	const ENavigationQueryResult::Type Result = CalcGridPathLength(PathStart, PathEnd, OutPathLength);
+	return Result != ENavigationQueryResult::Invalid ? Result : Super::CalcPathLength(PathStart, PathEnd, OutPathLength, QueryFilter, Querier);
+}
+
+ENavigationQueryResult::Type AProcGridNavMesh::CalcPathLengthAndCost(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength, FVector::FReal& OutPathCost, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier) const
+{
+	const ENavigationQueryResult::Type Result = CalcGridPathLength(PathStart, PathEnd, OutPathLength);
+	if (Result == ENavigationQueryResult::Invalid) return Super::CalcPathLengthAndCost(PathStart, PathEnd, OutPathLength, OutPathCost, QueryFilter, Querier);
+	OutPathCost = OutPathLength;
+	return Result;
+}
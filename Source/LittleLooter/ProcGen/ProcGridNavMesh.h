@@ -0,0 +1,55 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "NavMesh/RecastNavMesh.h"
+#include "ProcGridNavMesh.generated.h"
+
+class AProcMapManager;
+
+/**
+ * Navigation data for levels with grid nav maps. Set as the default agent's NavDataClass (DefaultEngine.ini),
+ * it is a plain Recast navmesh everywhere except over maps of AProcMapManagers in grid nav mode: queries
+ * starting there (paths, projection, raycasts, random points) are answered from the manager's grid nav
+ * graph, so MoveTo and FindPathSync follow its merged rectangles without any voxelized tiles.
+ *
+ * Path and raycast queries can run on the nav system's async query threads; the manager list is locked.
+ */
+UCLASS(NotPlaceable)
+class AProcGridNavMesh : public ARecastNavMesh
+{
+	GENERATED_BODY()
+public:
+	AProcGridNavMesh(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	/** Called by managers when they apply a grid mode map during play, and when they stop serving one. */
+	void AddGridManager(AProcMapManager* Manager);
+	void RemoveGridManager(AProcMapManager* Manager);
+
+	virtual bool ProjectPoint(const FVector& Point, FNavLocation& OutLocation, const FVector& Extent, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	using ARecastNavMesh::BatchProjectPoints;
+	virtual void BatchProjectPoints(TArray<FNavigationProjectionWork>& Workload, const FVector& Extent, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual FNavLocation GetRandomPoint(FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual bool GetRandomReachablePointInRadius(const FVector& Origin, float Radius, FNavLocation& OutResult, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual bool GetRandomPointInNavigableRadius(const FVector& Origin, float Radius, FNavLocation& OutResult, FSharedConstNavQueryFilter Filter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual ENavigationQueryResult::Type CalcPathCost(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathCost, FSharedConstNavQueryFilter QueryFilter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual ENavigationQueryResult::Type CalcPathLength(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength, FSharedConstNavQueryFilter QueryFilter = nullptr, const UObject* Querier = nullptr) const override;
+	virtual ENavigationQueryResult::Type CalcPathLengthAndCost(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength, FVector::FReal& OutPathCost, FSharedConstNavQueryFilter QueryFilter = nullptr, const UObject* Querier = nullptr) const override;
+
+	// Installed as this nav data's FindPath/TestPath/Raycast implementations; Recast's handle everything off grid maps
+	static FPathFindingResult FindGridPath(const FNavAgentProperties& AgentProperties, const FPathFindingQuery& Query);
+	static bool TestGridPath(const FNavAgentProperties& AgentProperties, const FPathFindingQuery& Query, int32* NumVisitedNodes);
+	static bool RaycastGrid(const ANavigationData* NavData, const FVector& RayStart, const FVector& RayEnd, FVector& HitLocation, FNavigationRaycastAdditionalResults* AdditionalResults, FSharedConstNavQueryFilter QueryFilter, const UObject* Querier);
+
+private:
+	mutable FCriticalSection ManagersLock;
+	TArray<TWeakObjectPtr<AProcMapManager>> GridManagers;
+
+	// Recast's implementations, taken over in the constructor
+	FFindPathPtr RecastFindPath = nullptr;
+	FTestPathPtr RecastTestPath = nullptr;
+	FNavRaycastPtr RecastRaycast = nullptr;
+
+	/** Grid mode manager whose map Location lies over, or null to leave the query to Recast. */
+	AProcMapManager* FindGridManager(const FVector& Location) const;
+	/** Length of the grid path, as Success/Fail; Invalid when no grid map is under PathStart, for Recast to answer. */
+	ENavigationQueryResult::Type CalcGridPathLength(const FVector& PathStart, const FVector& PathEnd, FVector::FReal& OutPathLength) const;
+};
@@ -0,0 +1,124 @@
+#include "ProcInstanceBuilder.h"
+
+namespace
+{
+	FORCEINLINE uint64 Part1By1_64(uint64 V)
+	{
+		V &= 0x00000000ffffffffull;
+		V = (V | (V << 16)) & 0x0000ffff0000ffffull;
+		V = (V | (V << 8))  & 0x00ff00ff00ff00ffull;
+		V = (V | (V << 4))  & 0x0f0f0f0f0f0f0f0full;
+		V = (V | (V << 2))  & 0x3333333333333333ull;
+		V = (V | (V << 1))  & 0x5555555555555555ull;
+		return V;
+	}
+
+	FORCEINLINE uint64 MortonKey(int32 X, int32 Y)
+	{
+		return Part1By1_64((uint32)X) | (Part1By1_64((uint32)Y) << 1);
+	}
+
+	struct FWalkableCell
+	{
+		uint64 Key;
+		int32 X;
+		int32 Y;
+		ECellType Type;
+		ECellFlags Edges;
+	};
+}
+
+static void EmitInstances(TArray<FWalkableCell>& Cells, const FProcInstanceSettings& Settings, FProcInstanceBatch& Out)
+{
+	Cells.Sort([](const FWalkableCell& A, const FWalkableCell& B) { return A.Key < B.Key; });
+
+	const auto GridToWorld = [&Settings](int32 X, int32 Y)
+	{
+		return Settings.Origin + FVector(X * Settings.GridTileSize, Y * Settings.GridTileSize, 0.f);
+	};
+
+	// Same placement rules the manager used per instance
+	const float S = Settings.EdgeTileSize;
+	const float H = Settings.WallHeight;
+	const float T = -300.f;
+	const auto PlaceEdge = [&](int32 X, int32 Y, ECellFlags Edge, float YawDeg, const FVector& LocalStart)
+	{
+		FTransform& EdgeTransform = Out.Walls.Emplace_GetRef(FRotator(0.f, YawDeg, 0.f), GridToWorld(X, Y) + LocalStart);
+		EdgeTransform.AddToTranslation(FVector(0, 0, H * 0.5f)); // raise to mid-height
+		Out.WallCells.Emplace(X, Y);
+		Out.WallEdges.Add(Edge);
+	};
+
+	for (const FWalkableCell& C : Cells)
+	{
+		if (Settings.bFloors && C.Type == ECellType::Floor)
+		{
+			Out.Floors.Emplace(FRotator::ZeroRotator, GridToWorld(C.X, C.Y), FVector(1.f));
+			Out.FloorCells.Emplace(C.X, C.Y);
+		}
+		if (Settings.bWalls)
+		{
+			if (EnumHasAnyFlags(C.Edges, ECellFlags::OpenSouth)) PlaceEdge(C.X, C.Y, ECellFlags::OpenSouth, 0.f, FVector(0.f, 0.f, 0.f));
+			if (EnumHasAnyFlags(C.Edges, ECellFlags::OpenNorth)) PlaceEdge(C.X, C.Y, ECellFlags::OpenNorth, 0.f, FVector(0.f, S - T, 0.f));
+			if (EnumHasAnyFlags(C.Edges, ECellFlags::OpenWest))  PlaceEdge(C.X, C.Y, ECellFlags::OpenWest, 90.f, FVector(0.f, 0.f, 0.f));
+			if (EnumHasAnyFlags(C.Edges, ECellFlags::OpenEast))  PlaceEdge(C.X, C.Y, ECellFlags::OpenEast, 90.f, FVector(S - T, 0.f, 0.f));
+		}
+	}
+}
+
+void FProcInstanceBuilder::Build(const FMapData& Map, const FProcInstanceSettings& Settings, FProcInstanceBatch& Out)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	Out.Reset();
+
+	TArray<FWalkableCell> Cells;
+	Map.ForEachCell([&Map, &Cells](int32 x, int32 y, ECellType Type)
+	{
+		if (Type != ECellType::Floor && Type != ECellType::Door) return;
+		Cells.Add({ MortonKey(x, y), x, y, Type, (ECellFlags)Map.GetFlags(x, y) });
+	});
+	EmitInstances(Cells, Settings, Out);
+
+	Out.BuildSeconds = FPlatformTime::Seconds() - StartSeconds;
+}
+
+void FProcInstanceBuilder::BuildRegion(const FMapData& Map, const FProcInstanceSettings& Settings, const FIntRect& Region, FProcInstanceBatch& Out)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	Out.Reset();
+
+	TArray<FWalkableCell> Cells;
+	const int32 MinX = FMath::Max(Region.Min.X, 0), MaxX = FMath::Min(Region.Max.X, Map.GetWidth());
+	const int32 MinY = FMath::Max(Region.Min.Y, 0), MaxY = FMath::Min(Region.Max.Y, Map.GetHeight());
+	for (int32 y = MinY; y < MaxY; ++y)
+		for (int32 x = MinX; x < MaxX; ++x)
+		{
+			const ECellType Type = Map.Get(x, y);
+			if (Type != ECellType::Floor && Type != ECellType::Door) continue;
+			Cells.Add({ MortonKey(x, y), x, y, Type, (ECellFlags)Map.GetFlags(x, y) });
+		}
+	EmitInstances(Cells, Settings, Out);
+
+	Out.BuildSeconds = FPlatformTime::Seconds() - StartSeconds;
+}
+
+void FProcInstanceBuilder::Partition(const FProcInstanceBatch& Batch, int32 ChunkSize, TMap<FIntPoint, FProcInstanceBatch>& OutChunks)
+{
+	ChunkSize = FMath::Max(ChunkSize, 1);
+	const auto ChunkOf = [ChunkSize](const FIntPoint& Cell) { return FIntPoint(Cell.X / ChunkSize, Cell.Y / ChunkSize); };
+
+	// Input is Morton-sorted, so each chunk's slice stays spatially sorted too
+	for (int32 i = 0; i < Batch.Floors.Num(); ++i)
+	{
+		FProcInstanceBatch& Chunk = OutChunks.FindOrAdd(ChunkOf(Batch.FloorCells[i]));
+		Chunk.Floors.Add(Batch.Floors[i]);
+		Chunk.FloorCells.Add(Batch.FloorCells[i]);
+	}
+	for (int32 i = 0; i < Batch.Walls.Num(); ++i)
+	{
+		FProcInstanceBatch& Chunk = OutChunks.FindOrAdd(ChunkOf(Batch.WallCells[i]));
+		Chunk.Walls.Add(Batch.Walls[i]);
+		Chunk.WallCells.Add(Batch.WallCells[i]);
+		Chunk.WallEdges.Add(Batch.WallEdges[i]);
+	}
+}
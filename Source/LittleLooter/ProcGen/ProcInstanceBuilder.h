@@ -0,0 +1,58 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+/** Everything the transform builder needs from the manager/tileset, copied so it can run off the game thread. */
+struct FProcInstanceSettings
+{
+	FVector Origin = FVector::ZeroVector; // GridToWorld origin
+	float GridTileSize = 400.f;           // AProcMapManager::TileSize
+	float EdgeTileSize = 100.f;           // UProcTileset::TileSize
+	float WallHeight = 300.f;
+	bool bFloors = true;
+	bool bWalls = true;
+
+	/** True if the same cell/edge maps to the same transform under both settings. */
+	bool HasSamePlacement(const FProcInstanceSettings& Other) const
+	{
+		return Origin.Equals(Other.Origin) && GridTileSize == Other.GridTileSize
+			&& EdgeTileSize == Other.EdgeTileSize && WallHeight == Other.WallHeight;
+	}
+};
+
+/** Flat per-mesh transform lists for one generated map, ready for AddInstances. */
+struct FProcInstanceBatch
+{
+	TArray<FTransform> Floors;
+	TArray<FTransform> Walls;
+	TArray<FIntPoint> FloorCells; // grid cell of each floor instance
+	TArray<FIntPoint> WallCells;  // grid cell whose edge each wall instance closes
+	TArray<ECellFlags> WallEdges; // which edge of WallCells[i] (single Open* bit)
+	double BuildSeconds = 0.0;
+
+	void Reset()
+	{
+		Floors.Reset();
+		Walls.Reset();
+		FloorCells.Reset();
+		WallCells.Reset();
+		WallEdges.Reset();
+		BuildSeconds = 0.0;
+	}
+};
+
+struct FProcInstanceBuilder
+{
+	/**
+	 * Builds floor and wall-edge transforms for Map. Cells are visited in Morton order so
+	 * consecutive instances are spatially close, which gives the HISM cluster tree tighter bounds.
+	 * Pure data; safe on any thread.
+	 */
+	static void Build(const FMapData& Map, const FProcInstanceSettings& Settings, FProcInstanceBatch& Out);
+
+	/** Same as Build but only for cells inside Region. */
+	static void BuildRegion(const FMapData& Map, const FProcInstanceSettings& Settings, const FIntRect& Region, FProcInstanceBatch& Out);
+
+	/** Splits a batch into ChunkSize x ChunkSize tile chunks, keyed by chunk coordinate. */
+	static void Partition(const FProcInstanceBatch& Batch, int32 ChunkSize, TMap<FIntPoint, FProcInstanceBatch>& OutChunks);
+};
@@ -0,0 +1,89 @@
+#include "ProcInstanceSlots.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+static const FTransform ParkedTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+int32 FProcInstanceSlots::Add(UInstancedStaticMeshComponent* ISM, uint64 Key, const FTransform& Transform)
+{
+	if (Update(ISM, Key, Transform)) return KeyToIndex[Key];
+
+	int32 Index;
+	if (FreeIndices.Num() > 0)
+	{
+		Index = FreeIndices.Pop(EAllowShrinking::No);
+		ISM->UpdateInstanceTransform(Index, Transform, /*bWorldSpace*/ false, /*bMarkRenderStateDirty*/ true, /*bTeleport*/ true);
+	}
+	else
+	{
+		Index = ISM->AddInstance(Transform);
+	}
+	KeyToIndex.Add(Key, Index);
+	return Index;
+}
+
+bool FProcInstanceSlots::Update(UInstancedStaticMeshComponent* ISM, uint64 Key, const FTransform& Transform)
+{
+	const int32 Index = Find(Key);
+	if (Index == INDEX_NONE) return false;
+	ISM->UpdateInstanceTransform(Index, Transform, /*bWorldSpace*/ false, /*bMarkRenderStateDirty*/ true, /*bTeleport*/ true);
+	return true;
+}
+
+bool FProcInstanceSlots::Remove(UInstancedStaticMeshComponent* ISM, uint64 Key)
+{
+	int32 Index;
+	if (!KeyToIndex.RemoveAndCopyValue(Key, Index)) return false;
+	ISM->UpdateInstanceTransform(Index, ParkedTransform, /*bWorldSpace*/ false, /*bMarkRenderStateDirty*/ true, /*bTeleport*/ true);
+	FreeIndices.Add(Index);
+	return true;
+}
+
+FProcInstanceSyncStats FProcInstanceSlots::Sync(UInstancedStaticMeshComponent* ISM, const TArray<uint64>& Keys, const TArray<FTransform>& Transforms, bool bUpdateExisting, TArray<uint64>* OutChanged)
+{
+	FProcInstanceSyncStats Stats;
+
+	TSet<uint64> Wanted;
+	Wanted.Reserve(Keys.Num());
+	for (const uint64 Key : Keys) Wanted.Add(Key);
+
+	TArray<uint64> Stale;
+	for (const TPair<uint64, int32>& KV : KeyToIndex)
+	{
+		if (!Wanted.Contains(KV.Key)) Stale.Add(KV.Key);
+	}
+	for (const uint64 Key : Stale) Remove(ISM, Key);
+	Stats.Removed = Stale.Num();
+	if (OutChanged) OutChanged->Append(Stale);
+
+	TArray<FTransform> Appended;
+	TArray<uint64> AppendedKeys;
+	for (int32 i = 0; i < Keys.Num(); ++i)
+	{
+		if (Find(Keys[i]) != INDEX_NONE)
+		{
+			if (bUpdateExisting) { Update(ISM, Keys[i], Transforms[i]); ++Stats.Updated; }
+			else ++Stats.Kept;
+		}
+		else if (FreeIndices.Num() > 0)
+		{
+			Add(ISM, Keys[i], Transforms[i]);
+			++Stats.Added;
+			if (OutChanged) OutChanged->Add(Keys[i]);
+		}
+		else
+		{
+			Appended.Add(Transforms[i]);
+			AppendedKeys.Add(Keys[i]);
+		}
+	}
+
+	if (Appended.Num() > 0)
+	{
+		const int32 FirstIndex = ISM->GetInstanceCount();
+		ISM->AddInstances(Appended, /*bShouldReturnIndices*/ false);
+		for (int32 i = 0; i < AppendedKeys.Num(); ++i) Track(AppendedKeys[i], FirstIndex + i);
+		Stats.Added += Appended.Num();
+		if (OutChanged) OutChanged->Append(AppendedKeys);
+	}
+	return Stats;
+}
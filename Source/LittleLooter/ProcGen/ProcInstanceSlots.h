@@ -0,0 +1,70 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+class UInstancedStaticMeshComponent;
+
+struct FProcInstanceSyncStats
+{
+	int32 Added = 0;
+	int32 Removed = 0;
+	int32 Updated = 0;
+	int32 Kept = 0;
+};
+
+/**
+ * Remembers which instance of a HISM shows which cell (floors) or cell edge (walls), so single
+ * cells can be updated without rebuilding the component. Removed instances are parked at zero
+ * scale (no render, no collision body) and their slots reused by later adds, so indices never shift.
+ */
+struct FProcInstanceSlots
+{
+	static FORCEINLINE uint64 MakeKey(const FIntPoint& Cell, ECellFlags Edge = ECellFlags::None)
+	{
+		return ((uint64)(uint32)Cell.Y << 36) | ((uint64)(uint32)Cell.X << 8) | (uint64)Edge;
+	}
+
+	static FORCEINLINE FIntPoint KeyToCell(uint64 Key)
+	{
+		return FIntPoint((int32)(uint32)((Key >> 8) & 0x0FFFFFFF), (int32)(uint32)(Key >> 36));
+	}
+
+	void Reset()
+	{
+		KeyToIndex.Reset();
+		FreeIndices.Reset();
+	}
+
+	/** Records that instance Index (already added to the component) shows Key. */
+	FORCEINLINE void Track(uint64 Key, int32 Index) { KeyToIndex.Add(Key, Index); }
+
+	FORCEINLINE int32 Find(uint64 Key) const
+	{
+		const int32* Index = KeyToIndex.Find(Key);
+		return Index ? *Index : INDEX_NONE;
+	}
+
+	/** Shows Key with Transform, reusing a parked slot if there is one. Returns the instance index. */
+	int32 Add(UInstancedStaticMeshComponent* ISM, uint64 Key, const FTransform& Transform);
+
+	/** Moves Key's instance to Transform. False if Key isn't shown. */
+	bool Update(UInstancedStaticMeshComponent* ISM, uint64 Key, const FTransform& Transform);
+
+	/** Parks Key's instance and frees its slot. False if Key isn't shown. */
+	bool Remove(UInstancedStaticMeshComponent* ISM, uint64 Key);
+
+	/**
+	 * Makes the component show exactly Keys[i] at Transforms[i]. Keys no longer wanted are parked,
+	 * new keys fill parked slots first and the rest are appended in one AddInstances call.
+	 * Keys already shown keep their instance; they are only moved if bUpdateExisting.
+	 * Keys added or removed are appended to OutChanged if given.
+	 */
+	FProcInstanceSyncStats Sync(UInstancedStaticMeshComponent* ISM, const TArray<uint64>& Keys, const TArray<FTransform>& Transforms, bool bUpdateExisting, TArray<uint64>* OutChanged = nullptr);
+
+	int32 Num() const { return KeyToIndex.Num(); }
+	int32 NumFree() const { return FreeIndices.Num(); }
+
+private:
+	TMap<uint64, int32> KeyToIndex;
+	TArray<int32> FreeIndices;
+};
@@ -0,0 +1,79 @@
+#include "ProcMapBakeCommandlet.h"
+#include "ProcMapManager.h"
+#include "ProcMapCache.h"
+#include "ProcMapFile.h"
+#include "MapGenerator.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "UObject/Package.h"
+
+UProcMapBakeCommandlet::UProcMapBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UProcMapBakeCommandlet::Main(const FString& Params)
+{
+	FString MapsArg = TEXT("/Game/Levels/ProcGenMap");
+	FParse::Value(*Params, TEXT("Maps="), MapsArg, /*bShouldStopOnSeparator*/ false);
+	TArray<FString> MapNames;
+	MapsArg.ParseIntoArray(MapNames, TEXT(","));
+
+	FString SeedsArg;
+	TArray<int32> Seeds;
+	if (FParse::Value(*Params, TEXT("Seeds="), SeedsArg, /*bShouldStopOnSeparator*/ false))
+	{
+		TArray<FString> SeedStrings;
+		SeedsArg.ParseIntoArray(SeedStrings, TEXT(","));
+		for (const FString& SeedString : SeedStrings) Seeds.Add(FCString::Atoi(*SeedString));
+	}
+
+	const FString BakedDir = FProcMapFile::GetBakedDir();
+	IFileManager::Get().MakeDirectory(*BakedDir, /*Tree*/ true);
+
+	UMapGenerator* Generator = NewObject<UMapGenerator>();
+	FMapData Map;
+	int32 NumBaked = 0, NumFailed = 0;
+	for (const FString& MapName : MapNames)
+	{
+		UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+		UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+		if (!World || !World->PersistentLevel)
+		{
+			UE_LOG(LogTemp, Error, TEXT("ProcMapBake: can't load level %s"), *MapName);
+			++NumFailed;
+			continue;
+		}
+
+		// Only actors saved in the persistent level; world partition cells aren't loaded here
+		for (AActor* Actor : World->PersistentLevel->Actors)
+		{
+			const AProcMapManager* Manager = Cast<AProcMapManager>(Actor);
+			if (!Manager) continue;
+
+			const FProcGenParams GenParams = Manager->MakeGenParams();
+			const TArray<int32> ManagerSeeds = Seeds.Num() > 0 ? Seeds : TArray<int32>{ Manager->Seed };
+			for (int32 Seed : ManagerSeeds)
+			{
+				const FProcMapCacheKey Key = FProcMapCacheKey::Make(GenParams, Seed);
+				const FString Path = BakedDir / Key.ToFileName(TEXT("pgbin"));
+				Generator->Run(GenParams, Seed, Map);
+				if (!FProcMapFile::Save(Map, Seed, Key.ParamsHash, Path))
+				{
+					UE_LOG(LogTemp, Error, TEXT("ProcMapBake: failed to write %s"), *Path);
+					++NumFailed;
+					continue;
+				}
+				UE_LOG(LogTemp, Display, TEXT("ProcMapBake: %s %s Seed=%d -> %s (%lld bytes)"), *MapName, *Manager->GetName(), Seed, *Path, IFileManager::Get().FileSize(*Path));
+				++NumBaked;
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("ProcMapBake: %d maps baked, %d failures"), NumBaked, NumFailed);
+	return NumFailed > 0 ? 1 : 0;
+}
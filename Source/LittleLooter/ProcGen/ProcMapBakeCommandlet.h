@@ -0,0 +1,22 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ProcMapBakeCommandlet.generated.h"
+
+/**
+ * Generates the maps of every AProcMapManager in the given levels and writes them to
+ * Content/ProcGen/Baked as .pgbin files, which managers load instead of generating. Not part of the
+ * cook; run it before BuildCookRun (the packaging step is spelled out in DefaultGame.ini):
+ *   UnrealEditor-Cmd LittleLooter.uproject -run=ProcMapBake [-Maps=/Game/Levels/A,/Game/Levels/B] [-Seeds=1,2,3]
+ * Without -Seeds each manager's own Seed is baked. Maps of older generator versions are left alone;
+ * they are simply never matched again.
+ */
+UCLASS()
+class UProcMapBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UProcMapBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,171 @@
+#include "ProcMapCache.h"
+#include "MapGenerator.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Tasks/Task.h"
+
+static constexpr uint32 CacheFileMagic = 0x50474D43; // "PGMC"
+static constexpr int32 CacheFileVersion = 1;
+
+FProcMapCacheKey FProcMapCacheKey::Make(const FProcGenParams& Params, int32 Seed)
+{
+	// Hash the exported text, so fields added to FProcGenParams later are part of the key automatically
+	FString Text;
+	FProcGenParams::StaticStruct()->ExportText(Text, &Params, nullptr, nullptr, PPF_None, nullptr);
+
+	FProcMapCacheKey Key;
+	Key.Seed = Seed;
+	Key.ParamsHash = CityHash64(reinterpret_cast<const char*>(*Text), Text.Len() * sizeof(TCHAR));
+	Key.GeneratorVersion = UMapGenerator::GeneratorVersion;
+	return Key;
+}
+
+FString FProcMapCacheKey::ToFileName(const TCHAR* Extension) const
+{
+	return FString::Printf(TEXT("%d_%016llx_v%d.%s"), Seed, ParamsHash, GeneratorVersion, Extension);
+}
+
+FProcMapCache& FProcMapCache::Get()
+{
+	static FProcMapCache Cache;
+	return Cache;
+}
+
+FString FProcMapCache::GetCacheDir()
+{
+	return FPaths::ProjectSavedDir() / TEXT("ProcGenCache");
+}
+
+bool FProcMapCache::Find(const FProcMapCacheKey& Key, FMapData& OutMap, bool bUseDisk)
+{
+	// Entries are immutable once added, so the copy can happen after the lock is dropped
+	TSharedPtr<const FMapData> Cached;
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (FEntry* Entry = Entries.Find(Key))
+		{
+			Entry->LastUsed = ++UseCounter;
+			Cached = Entry->Map;
+		}
+	}
+	if (Cached.IsValid())
+	{
+		OutMap = *Cached;
+		return true;
+	}
+	if (!bUseDisk || !LoadFromDisk(Key, OutMap)) return false;
+
+	AddToMemory(Key, MakeShared<const FMapData>(OutMap));
+	return true;
+}
+
+void FProcMapCache::Add(const FProcMapCacheKey& Key, const FMapData& Map, bool bUseDisk)
+{
+	const TSharedRef<FMapData> Copy = MakeShared<FMapData>(Map);
+	AddToMemory(Key, Copy);
+	if (!bUseDisk) return;
+
+	// Serializing costs about one copy of the map; compressing and writing happen on a worker
+	TArray<uint8> Raw;
+	FMemoryWriter Writer(Raw);
+	Copy->Serialize(Writer);
+
+	const FString Path = GetCacheDir() / Key.ToFileName();
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Raw = MoveTemp(Raw), Path]()
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Oodle, Raw.Num());
+		TArray<uint8> File;
+		FMemoryWriter Header(File);
+		uint32 Magic = CacheFileMagic;
+		int32 Version = CacheFileVersion;
+		int32 RawSize = Raw.Num();
+		Header << Magic << Version << RawSize;
+		const int32 HeaderSize = File.Num();
+		File.AddUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(NAME_Oodle, File.GetData() + HeaderSize, CompressedSize, Raw.GetData(), Raw.Num())) return;
+		File.SetNum(HeaderSize + CompressedSize);
+
+		// Write then rename, so a reader never sees half a file; two managers can store the same key at once
+		const FString TempPath = Path + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+		if (FFileHelper::SaveArrayToFile(File, *TempPath) && !IFileManager::Get().Move(*Path, *TempPath, /*bReplace*/ true))
+		{
+			IFileManager::Get().Delete(*TempPath, /*bRequireExists*/ false, /*bEvenReadOnly*/ false, /*bQuiet*/ true);
+		}
+	});
+}
+
+bool FProcMapCache::LoadFromDisk(const FProcMapCacheKey& Key, FMapData& OutMap) const
+{
+	TArray<uint8> File;
+	if (!FFileHelper::LoadFileToArray(File, *(GetCacheDir() / Key.ToFileName()), FILEREAD_Silent)) return false;
+
+	FMemoryReader Header(File);
+	uint32 Magic = 0;
+	int32 Version = 0, RawSize = 0;
+	Header << Magic << Version << RawSize;
+	if (Header.IsError() || Magic != CacheFileMagic || Version != CacheFileVersion || RawSize < 0) return false;
+
+	const int32 HeaderSize = (int32)Header.Tell();
+	TArray<uint8> Raw;
+	Raw.SetNumUninitialized(RawSize);
+	if (!FCompression::UncompressMemory(NAME_Oodle, Raw.GetData(), RawSize, File.GetData() + HeaderSize, File.Num() - HeaderSize)) return false;
+
+	FMemoryReader Reader(Raw);
+	OutMap.Serialize(Reader);
+	return !Reader.IsError();
+}
+
+void FProcMapCache::AddToMemory(const FProcMapCacheKey& Key, TSharedPtr<const FMapData> Map)
+{
+	const SIZE_T Bytes = sizeof(FMapData) + Map->GetAllocatedSize();
+	FScopeLock ScopeLock(&Lock);
+	if (const FEntry* Old = Entries.Find(Key)) MemoryBytes -= Old->Bytes;
+
+	FEntry& Entry = Entries.Add(Key);
+	Entry.Bytes = Bytes;
+	Entry.Map = MoveTemp(Map);
+	Entry.LastUsed = ++UseCounter;
+	MemoryBytes += Entry.Bytes;
+	EvictToBudget();
+}
+
+void FProcMapCache::EvictToBudget()
+{
+	// The newest map always stays, even if it alone is over budget
+	while (MemoryBytes > MemoryBudget && Entries.Num() > 1)
+	{
+		const FProcMapCacheKey* Oldest = nullptr;
+		uint64 OldestUse = MAX_uint64;
+		for (const TPair<FProcMapCacheKey, FEntry>& Pair : Entries)
+		{
+			if (Pair.Value.LastUsed < OldestUse)
+			{
+				OldestUse = Pair.Value.LastUsed;
+				Oldest = &Pair.Key;
+			}
+		}
+		const FProcMapCacheKey Key = *Oldest;
+		MemoryBytes -= Entries[Key].Bytes;
+		Entries.Remove(Key);
+	}
+}
+
+void FProcMapCache::SetMemoryBudget(SIZE_T InBytes)
+{
+	FScopeLock ScopeLock(&Lock);
+	MemoryBudget = InBytes;
+	EvictToBudget();
+}
+
+void FProcMapCache::ClearMemory()
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries.Reset();
+	MemoryBytes = 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+#include "Misc/ScopeLock.h"
+
+/** Everything a generated map depends on. */
+struct FProcMapCacheKey
+{
+	int32 Seed = 0;
+	uint64 ParamsHash = 0;
+	int32 GeneratorVersion = 0;
+
+	/** Key for Params/Seed with the current UMapGenerator::GeneratorVersion. */
+	static FProcMapCacheKey Make(const FProcGenParams& Params, int32 Seed);
+
+	/** Seed_ParamsHash_vVersion.Extension */
+	FString ToFileName(const TCHAR* Extension = TEXT("pgmap")) const;
+
+	bool operator==(const FProcMapCacheKey& Other) const
+	{
+		return Seed == Other.Seed && ParamsHash == Other.ParamsHash && GeneratorVersion == Other.GeneratorVersion;
+	}
+	friend uint32 GetTypeHash(const FProcMapCacheKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.Seed), GetTypeHash(Key.ParamsHash)), GetTypeHash(Key.GeneratorVersion));
+	}
+};
+
+/**
+ * Cache of generated maps: an in-memory LRU bounded by bytes, backed by compressed files under
+ * Saved/ProcGenCache so seeds survive level restarts and editor sessions.
+ * Process-wide (see Get) and safe to use from any thread: async generations look up and store on
+ * their workers. Map copies and disk reads happen outside the lock; disk writes on a background task.
+ */
+class FProcMapCache
+{
+public:
+	static FProcMapCache& Get();
+
+	/** Copies a cached map into OutMap. Memory first, then disk (a disk hit is kept in memory). */
+	bool Find(const FProcMapCacheKey& Key, FMapData& OutMap, bool bUseDisk = true);
+
+	/** Stores a copy of Map, evicting least recently used maps past the budget, and writes it to disk. */
+	void Add(const FProcMapCacheKey& Key, const FMapData& Map, bool bUseDisk = true);
+
+	void SetMemoryBudget(SIZE_T InBytes);
+	SIZE_T GetMemoryBytes() const { FScopeLock ScopeLock(&Lock); return MemoryBytes; }
+	int32 NumInMemory() const { FScopeLock ScopeLock(&Lock); return Entries.Num(); }
+
+	/** Drops the in-memory maps; files stay. */
+	void ClearMemory();
+
+	static FString GetCacheDir();
+
+private:
+	struct FEntry
+	{
+		TSharedPtr<const FMapData> Map;
+		SIZE_T Bytes = 0;
+		uint64 LastUsed = 0;
+	};
+
+	void AddToMemory(const FProcMapCacheKey& Key, TSharedPtr<const FMapData> Map);
+	void EvictToBudget(); // Lock held
+	bool LoadFromDisk(const FProcMapCacheKey& Key, FMapData& OutMap) const;
+
+	mutable FCriticalSection Lock; // guards everything below
+	TMap<FProcMapCacheKey, FEntry> Entries; // few maps fit a budget, so eviction just scans for the oldest
+	SIZE_T MemoryBytes = 0;
+	SIZE_T MemoryBudget = 256 * 1024 * 1024;
+	uint64 UseCounter = 0;
+};
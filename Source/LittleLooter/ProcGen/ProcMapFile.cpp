@@ -0,0 +1,276 @@
+#include "ProcMapFile.h"
+#include "MapGenerator.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+
+FProcMapFileView::FProcMapFileView() = default;
+
+FProcMapFileView::~FProcMapFileView()
+{
+	Close();
+}
+
+bool FProcMapFileView::Open(const FString& Path)
+{
+	Close();
+
+	// Map when the platform can; files it can't map (e.g. inside a pak) are read instead
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FOpenMappedResult Mapped = PlatformFile.OpenMappedEx(*Path);
+	if (Mapped.HasValue())
+	{
+		MappedHandle = Mapped.StealValue();
+		MappedRegion.Reset(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+	}
+	if (MappedRegion.IsValid())
+	{
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		MappedHandle.Reset();
+		if (!FFileHelper::LoadFileToArray(Loaded, *Path, FILEREAD_Silent)) return false;
+		Data = Loaded.GetData();
+		Size = Loaded.Num();
+	}
+
+	if (!Validate())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ProcMapFile: %s is not a valid baked map (format %d expected)."), *Path, FProcMapFileHeader::CurrentFormatVersion);
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool FProcMapFileView::OpenMemory(const uint8* Bytes, int64 NumBytes)
+{
+	Close();
+	Data = Bytes;
+	Size = NumBytes;
+	if (!Validate())
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FProcMapFileView::Close()
+{
+	// Region before handle
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+	Loaded.Empty();
+	Data = nullptr;
+	Size = 0;
+}
+
+TConstArrayView<FProcMapFileRoom> FProcMapFileView::GetRooms() const
+{
+	const FProcMapFileHeader& Header = GetHeader();
+	return TConstArrayView<FProcMapFileRoom>(reinterpret_cast<const FProcMapFileRoom*>(Data + Header.RoomsOffset), Header.NumRooms);
+}
+
+TConstArrayView<FIntPoint> FProcMapFileView::GetDoors() const
+{
+	const FProcMapFileHeader& Header = GetHeader();
+	return TConstArrayView<FIntPoint>(reinterpret_cast<const FIntPoint*>(Data + Header.DoorsOffset), Header.NumDoors);
+}
+
+bool FProcMapFileView::Validate() const
+{
+	if (!Data || Size < (int64)sizeof(FProcMapFileHeader) || !IsAligned(Data, 8)) return false;
+
+	const FProcMapFileHeader& Header = GetHeader();
+	if (Header.Magic != FProcMapFileHeader::MagicValue || Header.FormatVersion != FProcMapFileHeader::CurrentFormatVersion) return false;
+	if (Header.Storage > (uint8)EMapStorage::Chunked || Header.Width <= 0 || Header.Height <= 0 || int64(Header.Width) * Header.Height > MAX_int32) return false;
+	if (Header.NumRooms < 0 || Header.NumDoors < 0) return false;
+
+	const auto SectionFits = [this](uint32 Offset, int64 Bytes, uint32 Alignment)
+	{
+		return Offset >= sizeof(FProcMapFileHeader) && Offset % Alignment == 0 && int64(Offset) + Bytes <= Size;
+	};
+	if (!SectionFits(Header.CellRunsOffset, Header.CellRunsBytes, 1)) return false;
+	if (!SectionFits(Header.RoomsOffset, int64(Header.NumRooms) * sizeof(FProcMapFileRoom), alignof(FProcMapFileRoom))) return false;
+	if (!SectionFits(Header.DoorsOffset, int64(Header.NumDoors) * sizeof(FIntPoint), alignof(FIntPoint))) return false;
+
+	for (const FProcMapFileRoom& Room : GetRooms())
+	{
+		if (Room.FirstDoor < 0 || Room.NumDoors < 0 || int64(Room.FirstDoor) + Room.NumDoors > Header.NumDoors) return false;
+	}
+	return true;
+}
+
+static void AlignBytes(TArray<uint8>& Bytes)
+{
+	Bytes.AddZeroed(Align(Bytes.Num(), 8) - Bytes.Num());
+}
+
+template <typename T>
+static uint32 AppendSection(TArray<uint8>& Bytes, const T* Items, int32 Num)
+{
+	AlignBytes(Bytes);
+	const uint32 Offset = Bytes.Num();
+	Bytes.Append(reinterpret_cast<const uint8*>(Items), Num * sizeof(T));
+	return Offset;
+}
+
+static void AppendRun(TArray<uint8>& Bytes, uint8 Type, int64 Length)
+{
+	uint64 Rest = uint64(Length - 1);
+	Bytes.Add(Type | uint8((Rest & 31) << 3) | (Rest > 31 ? 4 : 0));
+	for (Rest >>= 5; Rest; )
+	{
+		const uint8 Low = Rest & 0x7F;
+		Rest >>= 7;
+		Bytes.Add(Low | (Rest ? 0x80 : 0));
+	}
+}
+
+void FProcMapFile::Write(const FMapData& Map, int32 Seed, uint64 ParamsHash, TArray<uint8>& OutBytes)
+{
+	FProcMapFileHeader Header;
+	Header.Storage = (uint8)Map.Storage;
+	Header.GeneratorVersion = UMapGenerator::GeneratorVersion;
+	Header.Seed = Seed;
+	Header.ParamsHash = ParamsHash;
+	Header.Width = Map.GetWidth();
+	Header.Height = Map.GetHeight();
+
+	const FMapValidation& V = Map.Validation;
+	Header.bValidated = V.bValidated;
+	Header.bPassed = V.bPassed;
+	Header.bStartReachesGoal = V.bStartReachesGoal;
+	Header.ReachablePercent = V.ReachablePercent;
+	Header.NumComponents = V.NumComponents;
+	Header.WalkableCells = V.WalkableCells;
+	Header.StartRoom = V.StartRoom;
+	Header.GoalRoom = V.GoalRoom;
+	Header.RepairCorridors = V.RepairCorridors;
+	Header.Attempts = V.Attempts;
+	Header.LayoutSeed = V.Seed;
+
+	OutBytes.Reset();
+	OutBytes.AddZeroed(sizeof(FProcMapFileHeader)); // patched at the end
+
+	// Runs continue across rows: most rows start and end in the same empty border as their neighbors
+	Header.CellRunsOffset = OutBytes.Num();
+	uint8 RunType = (uint8)Map.Get(0, 0);
+	int64 RunLength = 0;
+	for (int32 y = 0; y < Header.Height; ++y)
+		for (int32 x = 0; x < Header.Width; ++x)
+		{
+			const uint8 Type = (uint8)Map.Get(x, y);
+			if (Type != RunType)
+			{
+				AppendRun(OutBytes, RunType, RunLength);
+				RunType = Type;
+				RunLength = 0;
+			}
+			++RunLength;
+		}
+	if (RunLength > 0) AppendRun(OutBytes, RunType, RunLength);
+	Header.CellRunsBytes = OutBytes.Num() - Header.CellRunsOffset;
+
+	TArray<FProcMapFileRoom> Rooms;
+	TArray<FIntPoint> Doors;
+	Rooms.Reserve(Map.Rooms.Num());
+	for (const FRoom& Room : Map.Rooms)
+	{
+		Rooms.Add({ Room.Bounds, Doors.Num(), Room.DoorCells.Num() });
+		Doors.Append(Room.DoorCells);
+	}
+	Header.RoomsOffset = AppendSection(OutBytes, Rooms.GetData(), Rooms.Num());
+	Header.NumRooms = Rooms.Num();
+	Header.DoorsOffset = AppendSection(OutBytes, Doors.GetData(), Doors.Num());
+	Header.NumDoors = Doors.Num();
+	AlignBytes(OutBytes);
+
+	FMemory::Memcpy(OutBytes.GetData(), &Header, sizeof(Header));
+}
+
+bool FProcMapFile::Save(const FMapData& Map, int32 Seed, uint64 ParamsHash, const FString& Path)
+{
+	TArray<uint8> Bytes;
+	Write(Map, Seed, ParamsHash, Bytes);
+
+	// Unique temp name, so concurrent bakes of one key never write the same file
+	const FString TempPath = Path + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath)) return false;
+	if (IFileManager::Get().Move(*Path, *TempPath, /*bReplace*/ true)) return true;
+	IFileManager::Get().Delete(*TempPath, /*bRequireExists*/ false, /*bEvenReadOnly*/ false, /*bQuiet*/ true);
+	return false;
+}
+
+bool FProcMapFile::Read(const FProcMapFileView& View, FMapData& OutMap)
+{
+	if (!View.IsOpen()) return false;
+	const FProcMapFileHeader& Header = View.GetHeader();
+
+	OutMap.Reset();
+	OutMap.InitStorage((EMapStorage)Header.Storage, Header.Width, Header.Height, /*bWithRoomIds*/ true, /*bWithFlags*/ true);
+
+	// Dense storage takes runs as memsets; chunked storage only allocates chunks that have cells
+	const int32 Width = Header.Width;
+	const bool bDecoded = View.ForEachRun([&OutMap, Width](int32 FirstCell, int32 Length, ECellType Type)
+	{
+		if (Type == ECellType::Empty) return;
+		if (!OutMap.IsChunked())
+		{
+			FMemory::Memset(OutMap.Grid.Types.GetData() + FirstCell, (uint8)Type, Length);
+			return;
+		}
+		for (int32 Cell = FirstCell; Cell < FirstCell + Length; ++Cell)
+		{
+			OutMap.Set(Cell % Width, Cell / Width, Type);
+		}
+	});
+	if (!bDecoded) return false;
+
+	const TConstArrayView<FIntPoint> Doors = View.GetDoors();
+	OutMap.Rooms.Reserve(Header.NumRooms);
+	for (const FProcMapFileRoom& FileRoom : View.GetRooms())
+	{
+		const int32 RoomId = OutMap.Rooms.AddDefaulted();
+		FRoom& Room = OutMap.Rooms[RoomId];
+		Room.Bounds = FileRoom.Bounds;
+		Room.DoorCells = TArray<FIntPoint>(Doors.GetData() + FileRoom.FirstDoor, FileRoom.NumDoors);
+
+		// Same clipping as UMapGenerator::StampRoom
+		const int32 MinX = FMath::Max(Room.Bounds.Min.X, 0), MaxX = FMath::Min(Room.Bounds.Max.X, Header.Width);
+		const int32 MinY = FMath::Max(Room.Bounds.Min.Y, 0), MaxY = FMath::Min(Room.Bounds.Max.Y, Header.Height);
+		for (int32 y = MinY; y < MaxY; ++y)
+			for (int32 x = MinX; x < MaxX; ++x)
+			{
+				if (OutMap.IsWalkable(x, y)) OutMap.SetRoomId(x, y, RoomId);
+			}
+	}
+
+	FMapValidation& V = OutMap.Validation;
+	V.bValidated = Header.bValidated != 0;
+	V.bPassed = Header.bPassed != 0;
+	V.bStartReachesGoal = Header.bStartReachesGoal != 0;
+	V.ReachablePercent = Header.ReachablePercent;
+	V.NumComponents = Header.NumComponents;
+	V.WalkableCells = Header.WalkableCells;
+	V.StartRoom = Header.StartRoom;
+	V.GoalRoom = Header.GoalRoom;
+	V.RepairCorridors = Header.RepairCorridors;
+	V.Attempts = Header.Attempts;
+	V.Seed = Header.LayoutSeed;
+
+	// Walls are already in the cells; only the open-edge flags need deriving
+	UMapGenerator::RebuildOpenEdges(OutMap, /*bParallel*/ true);
+	return true;
+}
+
+FString FProcMapFile::GetBakedDir()
+{
+	return FPaths::ProjectContentDir() / TEXT("ProcGen/Baked");
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Baked map file (.pgbin). Little-endian, every section 8-byte aligned:
+ *   FProcMapFileHeader
+ *   cell runs    - RLE of the Types plane in row-major order (see FProcMapFileView::ForEachRun)
+ *   room table   - FProcMapFileRoom[NumRooms]
+ *   door table   - FIntPoint[NumDoors], referenced by the rooms
+ * Room ids and open-edge flags are derived from the room table and the cells on load.
+ */
+struct FProcMapFileHeader
+{
+	static constexpr uint32 MagicValue = 0x50474D42; // "PGMB"
+	static constexpr uint16 CurrentFormatVersion = 1;
+
+	uint32 Magic = MagicValue;
+	uint16 FormatVersion = CurrentFormatVersion;
+	uint8 Storage = 0; // EMapStorage
+	uint8 Pad0 = 0;
+	int32 GeneratorVersion = 0;
+	int32 Seed = 0;
+	uint64 ParamsHash = 0;
+	int32 Width = 0;
+	int32 Height = 0;
+	uint32 CellRunsOffset = 0;
+	uint32 CellRunsBytes = 0;
+	uint32 RoomsOffset = 0;
+	int32 NumRooms = 0;
+	uint32 DoorsOffset = 0;
+	int32 NumDoors = 0;
+
+	// FMapValidation, flattened
+	uint8 bValidated = 0;
+	uint8 bPassed = 0;
+	uint8 bStartReachesGoal = 0;
+	uint8 Pad1 = 0;
+	float ReachablePercent = 0.f;
+	int32 NumComponents = 0;
+	int32 WalkableCells = 0;
+	int32 StartRoom = INDEX_NONE;
+	int32 GoalRoom = INDEX_NONE;
+	int32 RepairCorridors = 0;
+	int32 Attempts = 0;
+	int32 LayoutSeed = 0;
+	uint32 Pad2 = 0;
+};
+static_assert(sizeof(FProcMapFileHeader) == 96, "FProcMapFileHeader is a file layout");
+
+struct FProcMapFileRoom
+{
+	FIntRect Bounds;
+	int32 FirstDoor;
+	int32 NumDoors;
+};
+static_assert(sizeof(FProcMapFileRoom) == 24, "FProcMapFileRoom is a file layout");
+
+/**
+ * Read-only view of a baked map. Open maps the file when the platform allows it (falls back to
+ * reading it into memory, e.g. from a pak), and every accessor points straight into those bytes.
+ */
+class FProcMapFileView
+{
+public:
+	FProcMapFileView();
+	~FProcMapFileView();
+
+	bool Open(const FString& Path);
+	/** Views Bytes, which must outlive the view. */
+	bool OpenMemory(const uint8* Bytes, int64 NumBytes);
+	void Close();
+
+	bool IsOpen() const { return Data != nullptr; }
+	const FProcMapFileHeader& GetHeader() const { return *reinterpret_cast<const FProcMapFileHeader*>(Data); }
+	TConstArrayView<FProcMapFileRoom> GetRooms() const;
+	TConstArrayView<FIntPoint> GetDoors() const;
+
+	/**
+	 * Calls Fn(FirstCell, Length, Type) for every run of equal cells, FirstCell being a row-major index.
+	 * Each run is one byte, type in bits 0-1, bit 2 set if more length bytes follow, bits 3-7 the low
+	 * bits of Length-1; the rest of Length-1 follows as LEB128. False if the runs don't cover the map.
+	 */
+	template <typename FuncType>
+	bool ForEachRun(FuncType&& Fn) const
+	{
+		const FProcMapFileHeader& Header = GetHeader();
+		const uint8* It = Data + Header.CellRunsOffset;
+		const uint8* End = It + Header.CellRunsBytes;
+		const int64 NumCells = int64(Header.Width) * Header.Height;
+		int64 Cell = 0;
+		while (It < End)
+		{
+			const uint8 First = *It++;
+			uint64 Length = First >> 3;
+			for (int32 Shift = 5; (First & 4) && It < End; Shift += 7)
+			{
+				const uint8 Next = *It++;
+				Length |= uint64(Next & 0x7F) << Shift;
+				if (!(Next & 0x80)) break;
+			}
+			++Length;
+			if (Cell + int64(Length) > NumCells) return false;
+			Fn(int32(Cell), int32(Length), ECellType(First & 3));
+			Cell += Length;
+		}
+		return Cell == NumCells;
+	}
+
+private:
+	bool Validate() const;
+
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray64<uint8> Loaded; // when the file can't be mapped
+};
+
+/** Writing and reading .pgbin maps. */
+struct FProcMapFile
+{
+	static void Write(const FMapData& Map, int32 Seed, uint64 ParamsHash, TArray<uint8>& OutBytes);
+	static bool Save(const FMapData& Map, int32 Seed, uint64 ParamsHash, const FString& Path);
+
+	/** Rebuilds a map from a view: cells, rooms and room ids, validation, then walls and open edges. */
+	static bool Read(const FProcMapFileView& View, FMapData& OutMap);
+
+	/** Where baked maps live; staged loose with the game (DirectoriesToAlwaysStageAsNonUFS) so they can be mapped. */
+	static FString GetBakedDir();
+};
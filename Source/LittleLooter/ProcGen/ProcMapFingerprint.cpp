@@ -0,0 +1,131 @@
+#include "ProcMapFingerprint.h"
+#include "ProcInstanceBuilder.h"
+#include "Hash/CityHash.h"
+
+namespace
+{
+	/** Appends values to a buffer that is hashed in blocks, so huge maps don't need one big copy. */
+	struct FHashStream
+	{
+		static constexpr int32 BlockBytes = 64 * 1024;
+
+		uint64 Hash;
+		TArray<uint8> Block;
+
+		explicit FHashStream(uint64 InSeed) : Hash(InSeed) { Block.Reserve(BlockBytes); }
+
+		template <typename T>
+		FORCEINLINE void Add(const T& Value)
+		{
+			static_assert(TIsArithmetic<T>::Value, "Hash fields one by one; struct padding isn't stable");
+			Block.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+			if (Block.Num() >= BlockBytes) Flush();
+		}
+
+		void Flush()
+		{
+			if (Block.Num() == 0) return;
+			Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Block.GetData()), Block.Num(), Hash);
+			Block.Reset();
+		}
+
+		uint64 Finish()
+		{
+			Flush();
+			return Hash;
+		}
+	};
+
+	void AddTransform(FHashStream& Stream, const FTransform& Transform)
+	{
+		const FVector T = Transform.GetTranslation();
+		const FQuat R = Transform.GetRotation();
+		const FVector S = Transform.GetScale3D();
+		Stream.Add(T.X); Stream.Add(T.Y); Stream.Add(T.Z);
+		Stream.Add(R.X); Stream.Add(R.Y); Stream.Add(R.Z); Stream.Add(R.W);
+		Stream.Add(S.X); Stream.Add(S.Y); Stream.Add(S.Z);
+	}
+}
+
+FProcMapFingerprint FProcMapFingerprint::Make(const FMapData& Map)
+{
+	FProcMapFingerprint Out;
+	FHashStream Cells(1), Corridors(2), Rooms(3);
+
+	const int32 Width = Map.GetWidth(), Height = Map.GetHeight();
+	Cells.Add(Width);
+	Cells.Add(Height);
+	for (int32 y = 0; y < Height; ++y)
+		for (int32 x = 0; x < Width; ++x)
+		{
+			const ECellType Type = Map.Get(x, y);
+			const int32 RoomId = Map.GetRoomId(x, y);
+			Cells.Add((uint8)Type);
+			Cells.Add(RoomId);
+			Cells.Add(Map.GetFlags(x, y));
+			if (RoomId == INDEX_NONE && (Type == ECellType::Floor || Type == ECellType::Door))
+			{
+				Corridors.Add(x);
+				Corridors.Add(y);
+				++Out.NumCorridorCells;
+			}
+		}
+
+	Rooms.Add(Map.Rooms.Num());
+	for (const FRoom& Room : Map.Rooms)
+	{
+		Rooms.Add(Room.Bounds.Min.X); Rooms.Add(Room.Bounds.Min.Y);
+		Rooms.Add(Room.Bounds.Max.X); Rooms.Add(Room.Bounds.Max.Y);
+		Rooms.Add(Room.DoorCells.Num());
+		for (const FIntPoint& Door : Room.DoorCells)
+		{
+			Rooms.Add(Door.X);
+			Rooms.Add(Door.Y);
+		}
+	}
+
+	Out.Cells = Cells.Finish();
+	Out.Corridors = Corridors.Finish();
+	Out.Rooms = Rooms.Finish();
+	return Out;
+}
+
+FProcMapFingerprint FProcMapFingerprint::Make(const FMapData& Map, const FProcInstanceBatch& Instances)
+{
+	FProcMapFingerprint Out = Make(Map);
+	Out.Instances = HashInstances(Instances);
+	return Out;
+}
+
+uint64 FProcMapFingerprint::HashInstances(const FProcInstanceBatch& Batch)
+{
+	FHashStream Stream(4);
+	Stream.Add(Batch.Floors.Num());
+	for (int32 i = 0; i < Batch.Floors.Num(); ++i)
+	{
+		AddTransform(Stream, Batch.Floors[i]);
+		Stream.Add(Batch.FloorCells[i].X);
+		Stream.Add(Batch.FloorCells[i].Y);
+	}
+	Stream.Add(Batch.Walls.Num());
+	for (int32 i = 0; i < Batch.Walls.Num(); ++i)
+	{
+		AddTransform(Stream, Batch.Walls[i]);
+		Stream.Add(Batch.WallCells[i].X);
+		Stream.Add(Batch.WallCells[i].Y);
+		Stream.Add((uint8)Batch.WallEdges[i]);
+	}
+	return Stream.Finish();
+}
+
+uint64 FProcMapFingerprint::GetCombined() const
+{
+	const uint64 Parts[5] = { Cells, Rooms, Corridors, Instances, uint64(NumCorridorCells) };
+	return CityHash64(reinterpret_cast<const char*>(Parts), sizeof(Parts));
+}
+
+FString FProcMapFingerprint::ToString() const
+{
+	return FString::Printf(TEXT("cells %016llx rooms %016llx corridors %016llx (%d cells) instances %016llx"),
+		Cells, Rooms, Corridors, NumCorridorCells, Instances);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+struct FProcInstanceBatch;
+
+/**
+ * Stable hashes of a generated map and its instances, for determinism checks. They depend only on
+ * the content: not on storage (dense or chunked), chunk allocation order, capacity or thread count.
+ */
+struct FProcMapFingerprint
+{
+	uint64 Cells = 0;     // size, then cell types, room ids and flags, row-major
+	uint64 Rooms = 0;     // room rects and door cells, in room id order
+	uint64 Corridors = 0; // walkable cells outside every room, row-major
+	uint64 Instances = 0; // floor then wall transforms with their cells and edges, in batch order; 0 if not hashed
+	int32 NumCorridorCells = 0;
+
+	static FProcMapFingerprint Make(const FMapData& Map);
+	static FProcMapFingerprint Make(const FMapData& Map, const FProcInstanceBatch& Instances);
+
+	static uint64 HashInstances(const FProcInstanceBatch& Batch);
+
+	/** Everything above in one value. */
+	uint64 GetCombined() const;
+	FString ToString() const;
+
+	bool operator==(const FProcMapFingerprint& Other) const
+	{
+		return Cells == Other.Cells && Rooms == Other.Rooms && Corridors == Other.Corridors
+			&& Instances == Other.Instances && NumCorridorCells == Other.NumCorridorCells;
+	}
+	bool operator!=(const FProcMapFingerprint& Other) const { return !(*this == Other); }
+};
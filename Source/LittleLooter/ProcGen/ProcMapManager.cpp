@@ -1,10 +1,30 @@
 #include "ProcMapManager.h"
 #include "MapGenerator.h"
+#include "ProcMapCache.h"
+#include "ProcMapFile.h"
+#include "ProcMapNetComponent.h"
+#include "ProcGridNavMesh.h"
+#include "HAL/FileManager.h"
 #include "NavigationSystem.h"
+#include "NavMesh/RecastNavMesh.h"
+#include "NavMesh/RecastNavMeshGenerator.h"
+#include "Algo/Sort.h"
+#include "TimerManager.h"
+#include "Async/Async.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/UnrealNetwork.h"
 
 AProcMapManager::AProcMapManager()
 {
-	PrimaryActorTick.bCanEverTick = false;
+	// Ticks only while committing instances over several frames
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// Clients in any part of the level need the seed to build the map
+	bReplicates = true;
+	bAlwaysRelevant = true;
 
 	USceneComponent* SceneRoot = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 	RootComponent = SceneRoot;
@@ -24,30 +44,104 @@ void AProcMapManager::BeginPlay()
 	}
 }
 
+void AProcMapManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Workers use generators we own; don't let them outlive us
+	CancelAsyncGeneration();
+	UE::Tasks::Wait(PendingTasks);
+	PendingTasks.Reset();
+	if (AProcGridNavMesh* NavMesh = GridNavMesh.Get()) NavMesh->RemoveGridManager(this);
+	GridNavMesh.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
+void AProcMapManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(AProcMapManager, NetState);
+}
+
+void AProcMapManager::OnRep_NetState()
+{
+	if (NetState.GeneratorVersion == 0) return;
+	Seed = NetState.Seed;
+	Params = NetState.Params;
+
+	// Another generator version can't be expected to match; ask for the server's map straight away
+	if (NetState.GeneratorVersion != UMapGenerator::GeneratorVersion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ProcGen net: server generator version %d, ours %d; requesting the full map"), NetState.GeneratorVersion, UMapGenerator::GeneratorVersion);
+		CancelAsyncGeneration();
+		MapHash = 0;
+		if (UProcMapNetComponent* Net = UProcMapNetComponent::FindLocal(GetWorld())) Net->ReportMap(this);
+		return;
+	}
+	Generate();
+}
+
+void AProcMapManager::ApplyReceivedMap(FMapData&& InMap)
+{
+	CancelAsyncGeneration();
+	if (!Tileset) return;
+	EnsureComponents();
+	Map = MoveTemp(InMap);
+	AppliedSeed = Seed; // the receiver only applies maps of the current Seed and params
+	AppliedParams = MakeGenParams();
+	RebuildGridNav();
+	Pathfinder.Init(Map);
+	RoomGraph.Build(Map);
+	FProcInstanceBuilder::Build(Map, MakeInstanceSettings(), PendingInstances);
+	ApplyMap(/*bAllowTimeSlicing*/ true);
+}
+
+TSharedPtr<const FProcMapNetPayload> AProcMapManager::GetNetPayload()
+{
+	if (!NetPayload.IsValid() || NetPayload->MapHash != MapHash)
+	{
+		NetPayload = UProcMapNetComponent::MakePayload(Map, NetState, MapHash);
+	}
+	return NetPayload;
+}
+
 void AProcMapManager::EnsureComponents()
 {
 	if (!Tileset) return;
 	FloorHISM->SetStaticMesh(Tileset->FloorMesh);
 	WallHISM->SetStaticMesh(Tileset->WallMesh);
 
-	// Basic collision expectations
+	// Basic collision expectations. In grid nav mode the map itself is the nav data (served through
+	// AProcGridNavMesh), so keep the instances out of the navigation octree entirely.
 	if (Tileset->FloorMesh)
 	{
 		FloorHISM->SetCollisionProfileName(TEXT("BlockAll"));
-		FloorHISM->SetCanEverAffectNavigation(true);
+		FloorHISM->SetCanEverAffectNavigation(NavMode == EProcNavMode::Recast);
 	}
 	if (Tileset->WallMesh)
 	{
 		WallHISM->SetCollisionProfileName(TEXT("BlockAll"));
-		WallHISM->SetCanEverAffectNavigation(true);
+		WallHISM->SetCanEverAffectNavigation(NavMode == EProcNavMode::Recast);
 	}
 }
 
 void AProcMapManager::Clear()
+{
+	CancelAsyncGeneration();
+	ClearInstances();
+	Map.Reset();
+	SetGridNav(FGridNavGraph());
+	Pathfinder.Reset();
+	RoomGraph.Reset();
+	QueueNavRebuild(NavChunks);
+	NavChunks.Reset();
+}
+
+void AProcMapManager::ClearInstances()
 {
 	if (FloorHISM) FloorHISM->ClearInstances();
 	if (WallHISM)  WallHISM->ClearInstances();
-	Map = FMapData();
+	FloorSlots.Reset();
+	WallSlots.Reset();
+	ResetStreamChunks();
 }
 
 void AProcMapManager::Generate()
@@ -62,78 +156,999 @@ void AProcMapManager::Generate()
 		Generator = NewObject<UMapGenerator>(this);
 	}
 
-	Clear();
+	CancelAsyncGeneration();
+
+	UWorld* World = GetWorld();
+	if (bAsyncGeneration && World && World->IsGameWorld())
+	{
+		StartAsyncGeneration();
+		return;
+	}
+
 	EnsureComponents();
+	const FProcGenParams GenParams = MakeGenParams();
+	const FProcMapCacheUse CacheUse = MakeCacheUse();
+	if (!(bUseBakedMaps && LoadBakedMap(GenParams, Seed, Map)) && !LoadCachedMap(CacheUse, GenParams, Seed, Map))
+	{
+		Generator->Run(GenParams, Seed, Map);
+		StoreCachedMap(CacheUse, GenParams, Seed, Map);
+	}
+	AppliedSeed = Seed;
+	AppliedParams = GenParams;
+	RebuildGridNav();
+	Pathfinder.Init(Map);
+	RoomGraph.Build(Map);
+	FProcInstanceBuilder::Build(Map, MakeInstanceSettings(), PendingInstances);
+	ApplyMap(/*bAllowTimeSlicing*/ false);
+}
+
+float AProcMapManager::GetGenerationProgress() const
+{
+	// Leave the last 10% for committing instances on the game thread
+	if (ActiveJob.IsValid()) return 0.9f * ActiveJob->State.GetProgress();
+	if (bCommittingInstances)
+	{
+		const int32 Total = PendingInstances.Floors.Num() + PendingInstances.Walls.Num();
+		return 0.9f + 0.1f * (Total > 0 ? float(CommittedFloors + CommittedWalls) / Total : 1.f);
+	}
+	return 1.f;
+}
 
-	Map = Generator->Run(Params, Seed);
+void AProcMapManager::CancelAsyncGeneration()
+{
+	if (ActiveJob.IsValid())
+	{
+		ActiveJob->State.Cancel();
+		ActiveJob.Reset();
+	}
+	if (bCommittingInstances)
+	{
+		EndInstanceCommit(/*bCompleted*/ false);
+	}
+}
 
-	int32 FloorCount = 0, WallCount = 0;
+FProcGenParams AProcMapManager::MakeGenParams() const
+{
+	FProcGenParams GenParams = Params;
+	if (Tileset && Tileset->bOverrideLayout) GenParams.Layout = Tileset->Layout;
+	return GenParams;
+}
 
-	auto IsFloor = [this](const FMapData& M, int32 X, int32 Y)
+bool AProcMapManager::LoadBakedMap(const FProcGenParams& GenParams, int32 InSeed, FMapData& OutMap)
+{
+	const double Start = FPlatformTime::Seconds();
+	const FString Path = FProcMapFile::GetBakedDir() / FProcMapCacheKey::Make(GenParams, InSeed).ToFileName(TEXT("pgbin"));
+	FProcMapFileView View;
+	if (!IFileManager::Get().FileExists(*Path) || !View.Open(Path) || !FProcMapFile::Read(View, OutMap)) return false;
+
+	UE_LOG(LogTemp, Log, TEXT("ProcGen baked map for Seed=%d, loaded in %.2f ms"), InSeed, (FPlatformTime::Seconds() - Start) * 1000.0);
+	return true;
+}
+
+FProcMapCacheUse AProcMapManager::MakeCacheUse() const
+{
+	FProcMapCacheUse CacheUse;
+	CacheUse.bMemory = bUseMapCache;
+	CacheUse.bDisk = bUseMapCache && bUseDiskMapCache;
+	CacheUse.BudgetBytes = SIZE_T(FMath::Max(MapCacheBudgetMB, 0)) * 1024 * 1024;
+	return CacheUse;
+}
+
+bool AProcMapManager::LoadCachedMap(const FProcMapCacheUse& CacheUse, const FProcGenParams& GenParams, int32 InSeed, FMapData& OutMap)
+{
+	if (!CacheUse.bMemory) return false;
+	const double Start = FPlatformTime::Seconds();
+	FProcMapCache& Cache = FProcMapCache::Get();
+	Cache.SetMemoryBudget(CacheUse.BudgetBytes);
+	if (!Cache.Find(FProcMapCacheKey::Make(GenParams, InSeed), OutMap, CacheUse.bDisk)) return false;
+
+	UE_LOG(LogTemp, Log, TEXT("ProcGen cache hit for Seed=%d, loaded in %.2f ms"), InSeed, (FPlatformTime::Seconds() - Start) * 1000.0);
+	return true;
+}
+
+void AProcMapManager::StoreCachedMap(const FProcMapCacheUse& CacheUse, const FProcGenParams& GenParams, int32 InSeed, const FMapData& InMap)
+{
+	if (!CacheUse.bMemory) return;
+	FProcMapCache& Cache = FProcMapCache::Get();
+	Cache.SetMemoryBudget(CacheUse.BudgetBytes);
+	Cache.Add(FProcMapCacheKey::Make(GenParams, InSeed), InMap, CacheUse.bDisk);
+}
+
+FProcInstanceSettings AProcMapManager::MakeInstanceSettings() const
+{
+	FProcInstanceSettings Settings;
+	Settings.Origin = GetActorLocation();
+	Settings.GridTileSize = TileSize;
+	Settings.EdgeTileSize = Tileset ? Tileset->TileSize : 100.f;
+	Settings.WallHeight = Tileset ? Tileset->WallHeight : 300.f;
+	Settings.bFloors = Tileset && Tileset->FloorMesh;
+	Settings.bWalls = Tileset && Tileset->WallMesh;
+	return Settings;
+}
+
+void AProcMapManager::StartAsyncGeneration()
+{
+	UMapGenerator* JobGenerator = FreeAsyncGenerators.Num() > 0 ? FreeAsyncGenerators.Pop() : nullptr;
+	if (JobGenerator == nullptr)
 	{
-		if (const FCell* C = M.Cells.Find(FIntPoint(X,Y)))
-			return C->Type == ECellType::Floor || C->Type == ECellType::Door;
-		return false;
+		JobGenerator = NewObject<UMapGenerator>(this);
+		AsyncGenerators.Add(JobGenerator);
+	}
+
+	TSharedPtr<FProcMapAsyncJob, ESPMode::ThreadSafe> Job = MakeShared<FProcMapAsyncJob, ESPMode::ThreadSafe>();
+	Job->Params = MakeGenParams();
+	Job->Seed = Seed;
+	Job->InstanceSettings = MakeInstanceSettings();
+	Job->Generator = JobGenerator;
+	Job->bBuildGridNav = NavMode == EProcNavMode::Grid;
+	Job->CacheUse = MakeCacheUse();
+	Job->bUseBakedMaps = bUseBakedMaps;
+	ActiveJob = Job;
+
+	PendingTasks.RemoveAll([](const UE::Tasks::FTask& Task) { return Task.IsCompleted(); });
+	TWeakObjectPtr<AProcMapManager> WeakThis(this);
+	PendingTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job, WeakThis]()
+	{
+		// Baked loads, cache lookups and stores read, copy and serialize whole maps, so they stay off the game thread too
+		Job->bFromCache = (Job->bUseBakedMaps && LoadBakedMap(Job->Params, Job->Seed, Job->Result))
+			|| LoadCachedMap(Job->CacheUse, Job->Params, Job->Seed, Job->Result);
+		if (!Job->bFromCache)
+		{
+			Job->Generator->Run(Job->Params, Job->Seed, Job->Result, &Job->State);
+			if (!Job->State.IsCancelled()) StoreCachedMap(Job->CacheUse, Job->Params, Job->Seed, Job->Result);
+		}
+		if (!Job->State.IsCancelled())
+		{
+			FProcInstanceBuilder::Build(Job->Result, Job->InstanceSettings, Job->Instances);
+			if (Job->bBuildGridNav) Job->GridNav.Build(Job->Result);
+			Job->Pathfinder.Init(Job->Result);
+			Job->RoomGraph.Build(Job->Result);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [Job, WeakThis]()
+		{
+			if (AProcMapManager* This = WeakThis.Get())
+			{
+				This->OnAsyncGenerationFinished(Job);
+			}
+		});
+	}));
+}
+
+void AProcMapManager::OnAsyncGenerationFinished(const TSharedPtr<FProcMapAsyncJob, ESPMode::ThreadSafe>& Job)
+{
+	FreeAsyncGenerators.Add(Job->Generator);
+
+	// Superseded by a newer Generate()/Clear(), or cancelled: drop the result
+	if (Job != ActiveJob || Job->State.IsCancelled()) return;
+	ActiveJob.Reset();
+
+	if (!Tileset) return;
+	EnsureComponents();
+	Map = MoveTemp(Job->Result);
+	AppliedSeed = Job->Seed;
+	AppliedParams = Job->Params;
+	PendingInstances = MoveTemp(Job->Instances);
+	SetGridNav(MoveTemp(Job->GridNav));
+	Pathfinder = MoveTemp(Job->Pathfinder);
+	RoomGraph = MoveTemp(Job->RoomGraph);
+	ApplyMap(/*bAllowTimeSlicing*/ true);
+}
+
+void AProcMapManager::ApplyMap(bool bAllowTimeSlicing)
+{
+	// Streamed maps only commit the chunks near players; everything else, and editor previews (which
+	// have no players to stream around), commits all instances
+	const UWorld* World = GetWorld();
+	if (bStreamChunks && World && World->IsGameWorld())
+	{
+		ClearInstances();
+		BuildStreamChunks();
+		FinishApply();
+		return;
+	}
+	ApplyInstances(bAllowTimeSlicing);
+}
+
+void AProcMapManager::ApplyInstances(bool bAllowTimeSlicing)
+{
+	const FProcInstanceSettings Settings = MakeInstanceSettings();
+	if (CanSyncInstances(Settings))
+	{
+		TSet<FIntPoint> ChangedNavChunks;
+		SyncInstances(Settings, ChangedNavChunks);
+		FinishApply(&ChangedNavChunks);
+		return;
+	}
+
+	ClearInstances();
+	AppliedInstanceSettings = Settings;
+	BeginInstanceCommit(bAllowTimeSlicing);
+}
+
+bool AProcMapManager::CanSyncInstances(const FProcInstanceSettings& Settings) const
+{
+	if (!bDiffInstancesOnRegenerate || StreamChunks.Num() > 0) return false;
+	if (FloorSlots.Num() + WallSlots.Num() == 0) return false;
+
+	// Once more than half the slots are parked a clean rebuild is cheaper to render than the holes
+	const int32 Live = FloorSlots.Num() + WallSlots.Num();
+	const int32 Parked = FloorSlots.NumFree() + WallSlots.NumFree();
+	return Parked <= Live;
+}
+
+void AProcMapManager::SyncInstances(const FProcInstanceSettings& Settings, TSet<FIntPoint>& OutChangedNavChunks)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	const bool bMoved = !Settings.HasSamePlacement(AppliedInstanceSettings);
+	AppliedInstanceSettings = Settings;
+
+	TArray<uint64> FloorKeys, WallKeys;
+	FloorKeys.Reserve(PendingInstances.Floors.Num());
+	WallKeys.Reserve(PendingInstances.Walls.Num());
+	for (const FIntPoint& Cell : PendingInstances.FloorCells) FloorKeys.Add(FProcInstanceSlots::MakeKey(Cell));
+	for (int32 i = 0; i < PendingInstances.Walls.Num(); ++i)
+	{
+		WallKeys.Add(FProcInstanceSlots::MakeKey(PendingInstances.WallCells[i], PendingInstances.WallEdges[i]));
+	}
+
+	FloorHISM->bAutoRebuildTreeOnInstanceChanges = false;
+	WallHISM->bAutoRebuildTreeOnInstanceChanges = false;
+	TArray<uint64> ChangedKeys;
+	const FProcInstanceSyncStats FloorStats = FloorSlots.Sync(FloorHISM, FloorKeys, PendingInstances.Floors, bMoved, &ChangedKeys);
+	const FProcInstanceSyncStats WallStats = WallSlots.Sync(WallHISM, WallKeys, PendingInstances.Walls, bMoved, &ChangedKeys);
+	FloorHISM->bAutoRebuildTreeOnInstanceChanges = true;
+	WallHISM->bAutoRebuildTreeOnInstanceChanges = true;
+	FloorHISM->BuildTreeIfOutdated(/*Async*/ true, /*ForceUpdate*/ false);
+	WallHISM->BuildTreeIfOutdated(/*Async*/ true, /*ForceUpdate*/ false);
+
+	// A moved map invalidates everything; otherwise only where instances came or went
+	if (bMoved)
+	{
+		OutChangedNavChunks.Append(NavChunks);
+		CollectNavChunks(PendingInstances, OutChangedNavChunks);
+	}
+	else
+	{
+		const int32 CS = NavDirtyChunkSize;
+		for (const uint64 Key : ChangedKeys)
+		{
+			const FIntPoint Cell = FProcInstanceSlots::KeyToCell(Key);
+			OutChangedNavChunks.Add(FIntPoint(Cell.X / CS, Cell.Y / CS));
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("ProcGen instance diff in %.2f ms: floors +%d -%d ~%d =%d, walls +%d -%d ~%d =%d"),
+		(FPlatformTime::Seconds() - StartSeconds) * 1000.0,
+		FloorStats.Added, FloorStats.Removed, FloorStats.Updated, FloorStats.Kept,
+		WallStats.Added, WallStats.Removed, WallStats.Updated, WallStats.Kept);
+}
+
+void AProcMapManager::BeginInstanceCommit(bool bAllowTimeSlicing)
+{
+	CommittedFloors = CommittedWalls = CommitFrames = 0;
+	CommitSeconds = 0.0;
+	bCommittingInstances = true;
+
+	// Defer cluster tree builds until every batch has landed
+	FloorHISM->bAutoRebuildTreeOnInstanceChanges = false;
+	WallHISM->bAutoRebuildTreeOnInstanceChanges = false;
+
+	if (!bAllowTimeSlicing || InstanceCommitBudgetPerFrame <= 0)
+	{
+		CommitInstanceSlice(MAX_int32);
+		EndInstanceCommit(/*bCompleted*/ true);
+		return;
+	}
+	SetActorTickEnabled(true);
+}
+
+void AProcMapManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bCommittingInstances && CommitInstanceSlice(InstanceCommitBudgetPerFrame))
+	{
+		EndInstanceCommit(/*bCompleted*/ true);
+	}
+	if (StreamChunks.Num() > 0)
+	{
+		UpdateStreaming();
+	}
+}
+
+bool AProcMapManager::CommitInstanceSlice(int32 Budget)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	++CommitFrames;
+
+	const auto CommitRange = [&Budget](UHierarchicalInstancedStaticMeshComponent* HISM, FProcInstanceSlots& Slots,
+		const TArray<FTransform>& Source, TFunctionRef<uint64(int32)> KeyOf, int32& Cursor)
+	{
+		const int32 Count = FMath::Min(Source.Num() - Cursor, Budget);
+		if (Count <= 0) return;
+
+		// AddInstances appends, so the new instances take the next indices in order
+		const int32 FirstIndex = HISM->GetInstanceCount();
+		for (int32 i = 0; i < Count; ++i) Slots.Track(KeyOf(Cursor + i), FirstIndex + i);
+
+		if (Cursor == 0 && Count == Source.Num())
+		{
+			HISM->AddInstances(Source, /*bShouldReturnIndices*/ false);
+		}
+		else
+		{
+			HISM->AddInstances(TArray<FTransform>(Source.GetData() + Cursor, Count), /*bShouldReturnIndices*/ false);
+		}
+		Cursor += Count;
+		Budget -= Count;
 	};
+	CommitRange(FloorHISM, FloorSlots, PendingInstances.Floors,
+		[this](int32 i) { return FProcInstanceSlots::MakeKey(PendingInstances.FloorCells[i]); }, CommittedFloors);
+	CommitRange(WallHISM, WallSlots, PendingInstances.Walls,
+		[this](int32 i) { return FProcInstanceSlots::MakeKey(PendingInstances.WallCells[i], PendingInstances.WallEdges[i]); }, CommittedWalls);
+
+	CommitSeconds += FPlatformTime::Seconds() - StartSeconds;
+	return CommittedFloors == PendingInstances.Floors.Num() && CommittedWalls == PendingInstances.Walls.Num();
+}
+
+void AProcMapManager::EndInstanceCommit(bool bCompleted)
+{
+	bCommittingInstances = false;
+	SetActorTickEnabled(StreamChunks.Num() > 0);
+
+	FloorHISM->bAutoRebuildTreeOnInstanceChanges = true;
+	WallHISM->bAutoRebuildTreeOnInstanceChanges = true;
+	if (!bCompleted) return;
+
+	const double TreeStart = FPlatformTime::Seconds();
+	FloorHISM->BuildTreeIfOutdated(/*Async*/ true, /*ForceUpdate*/ true);
+	WallHISM->BuildTreeIfOutdated(/*Async*/ true, /*ForceUpdate*/ true);
 
+	UE_LOG(LogTemp, Log, TEXT("ProcGen instances: built %d floors + %d walls in %.2f ms, committed in %.2f ms over %d frame(s), tree build kicked in %.2f ms"),
+		PendingInstances.Floors.Num(), PendingInstances.Walls.Num(), PendingInstances.BuildSeconds * 1000.0,
+		CommitSeconds * 1000.0, CommitFrames, (FPlatformTime::Seconds() - TreeStart) * 1000.0);
 
-	// ---------- PASS 1: FLOORS ----------
-	for (const auto& KV : Map.Cells)
+	FinishApply();
+}
+
+void AProcMapManager::CarveRegion(FIntPoint Min, FIntPoint Max, ECellType Type)
+{
+	if (Type == ECellType::Wall)
 	{
-		const FCell& C = KV.Value;
-		const FVector Pos = GridToWorld(C.X, C.Y);
+		UE_LOG(LogTemp, Warning, TEXT("ProcMapManager: walls are derived from floors; carve Empty instead."));
+		return;
+	}
+
+	const FIntRect Region(FMath::Max(Min.X, 0), FMath::Max(Min.Y, 0), FMath::Min(Max.X, Map.GetWidth()), FMath::Min(Max.Y, Map.GetHeight()));
+	if (Region.Min.X >= Region.Max.X || Region.Min.Y >= Region.Max.Y || IsGenerating()) return;
 
-		if (C.Type == ECellType::Floor && Tileset->FloorMesh)
+	for (int32 y = Region.Min.Y; y < Region.Max.Y; ++y)
+		for (int32 x = Region.Min.X; x < Region.Max.X; ++x)
 		{
-			FTransform FloorTransform(FRotator::ZeroRotator, Pos, FVector(1.f));
-			FloorHISM->AddInstance(FloorTransform);
-			++FloorCount;
+			Map.Set(x, y, Type);
+			if (Type == ECellType::Empty) Map.SetRoomId(x, y, INDEX_NONE);
 		}
+	RegenerateRegion(Region);
+}
+
+void AProcMapManager::RegenerateRegion(const FIntRect& Region)
+{
+	if (IsGenerating())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ProcMapManager: RegenerateRegion ignored while a generation is in flight."));
+		return;
+	}
+	if (!Tileset || Map.GetWidth() == 0) return;
+	if (Generator == nullptr)
+	{
+		Generator = NewObject<UMapGenerator>(this);
 	}
 
-	// ---------- PASS 2: WALLS ----------
-	if (Tileset->WallMesh)
+	const double StartSeconds = FPlatformTime::Seconds();
+	const FIntRect Affected = Generator->RebuildWallsAndEdges(Map, Region);
+	if (Affected.Min.X >= Affected.Max.X || Affected.Min.Y >= Affected.Max.Y) return;
+
+	const int32 Touched = StreamChunks.Num() > 0 ? RefreshStreamChunks(Affected) : ApplyRegionInstances(Affected);
+
+	const int32 CS = NavDirtyChunkSize;
+	for (int32 cy = Affected.Min.Y / CS; cy <= (Affected.Max.Y - 1) / CS; ++cy)
+		for (int32 cx = Affected.Min.X / CS; cx <= (Affected.Max.X - 1) / CS; ++cx)
+		{
+			NavChunks.Add(FIntPoint(cx, cy));
+		}
+	Pathfinder.UpdateRegion(Map, Affected);
+	RoomGraph.OnCellsChanged(Map, Affected);
+	if (NavMode == EProcNavMode::Grid)
+	{
+		RebuildGridNav();
+		OnNavReady.Broadcast();
+	}
+	else
 	{
-		const float S = Tileset->TileSize;
-		const float H = Tileset->WallHeight;
-		const float T = -300.f;
+		QueueNavRebuild({ GridRectToWorldBounds(Affected) });
+	}
 
-		auto PlaceEdge = [&](int32 X, int32 Y, float YawDeg, const FVector& LocalStart)
-			{
-				FTransform T(FRotator(0.f, YawDeg, 0.f), GridToWorld(X, Y) + LocalStart);
-				T.AddToTranslation(FVector(0, 0, H * 0.5f));     // raise to mid-height
-				WallHISM->AddInstance(T);
-				++WallCount;
-			};
-
-		// Iterate the grid once; only place edges around FLOOR cells to avoid duplicates
-		for (int32 y = 0; y < Params.Height; ++y)
-			for (int32 x = 0; x < Params.Width; ++x)
+	UE_LOG(LogTemp, Log, TEXT("ProcGen region (%d,%d)-(%d,%d) rebuilt in %.2f ms, %d instances touched"),
+		Affected.Min.X, Affected.Min.Y, Affected.Max.X, Affected.Max.Y, (FPlatformTime::Seconds() - StartSeconds) * 1000.0, Touched);
+}
+
+int32 AProcMapManager::ApplyRegionInstances(const FIntRect& Affected)
+{
+	FProcInstanceBatch Local;
+	FProcInstanceBuilder::BuildRegion(Map, MakeInstanceSettings(), Affected, Local);
+
+	TSet<uint64> WantedFloors, WantedWalls;
+	for (int32 i = 0; i < Local.Floors.Num(); ++i) WantedFloors.Add(FProcInstanceSlots::MakeKey(Local.FloorCells[i]));
+	for (int32 i = 0; i < Local.Walls.Num(); ++i) WantedWalls.Add(FProcInstanceSlots::MakeKey(Local.WallCells[i], Local.WallEdges[i]));
+
+	// Drop what the region no longer has...
+	static const ECellFlags Edges[] = { ECellFlags::OpenSouth, ECellFlags::OpenNorth, ECellFlags::OpenWest, ECellFlags::OpenEast };
+	int32 Touched = 0;
+	for (int32 y = Affected.Min.Y; y < Affected.Max.Y; ++y)
+		for (int32 x = Affected.Min.X; x < Affected.Max.X; ++x)
+		{
+			const uint64 FloorKey = FProcInstanceSlots::MakeKey(FIntPoint(x, y));
+			if (!WantedFloors.Contains(FloorKey) && FloorSlots.Remove(FloorHISM, FloorKey)) ++Touched;
+			for (const ECellFlags Edge : Edges)
 			{
-				if (!IsFloor(Map, x, y)) continue;
+				const uint64 WallKey = FProcInstanceSlots::MakeKey(FIntPoint(x, y), Edge);
+				if (!WantedWalls.Contains(WallKey) && WallSlots.Remove(WallHISM, WallKey)) ++Touched;
+			}
+		}
+
+	// ...then add what's new. Positions are a pure function of cell and edge, so existing keys stay as they are.
+	for (int32 i = 0; i < Local.Floors.Num(); ++i)
+	{
+		const uint64 Key = FProcInstanceSlots::MakeKey(Local.FloorCells[i]);
+		if (FloorSlots.Find(Key) == INDEX_NONE) { FloorSlots.Add(FloorHISM, Key, Local.Floors[i]); ++Touched; }
+	}
+	for (int32 i = 0; i < Local.Walls.Num(); ++i)
+	{
+		const uint64 Key = FProcInstanceSlots::MakeKey(Local.WallCells[i], Local.WallEdges[i]);
+		if (WallSlots.Find(Key) == INDEX_NONE) { WallSlots.Add(WallHISM, Key, Local.Walls[i]); ++Touched; }
+	}
+	return Touched;
+}
 
-				// South edge of (x,y): start at BL corner of the cell
-				if (!IsFloor(Map, x, y - 1))  PlaceEdge(x, y, 0.f, FVector(0.f, 0.f, 0.f));
+FBox AProcMapManager::GridRectToWorldBounds(const FIntRect& Rect) const
+{
+	// Instances are added in component space, so map the grid-space corners through the actor transform.
+	// One tile of slack covers wall edges that sit on the rect border.
+	const float WallHeight = Tileset ? Tileset->WallHeight : 300.f;
+	const FVector Min = GridToWorld(Rect.Min.X - 1, Rect.Min.Y - 1) - FVector(0.f, 0.f, TileSize);
+	const FVector Max = GridToWorld(Rect.Max.X + 1, Rect.Max.Y + 1) + FVector(0.f, 0.f, WallHeight + TileSize);
+	return FBox(Min, Max).TransformBy(GetActorTransform());
+}
+
+void AProcMapManager::BuildStreamChunks()
+{
+	TMap<FIntPoint, FProcInstanceBatch> Partitioned;
+	FProcInstanceBuilder::Partition(PendingInstances, StreamingChunkSize, Partitioned);
+
+	StreamChunks.Reset(Partitioned.Num());
+	StreamChunkLookup.Reset();
+	for (TPair<FIntPoint, FProcInstanceBatch>& KV : Partitioned)
+	{
+		AddStreamChunk(KV.Key).Instances = MoveTemp(KV.Value);
+	}
+	StreamQueue.Reserve(StreamChunks.Num());
+
+	UE_LOG(LogTemp, Log, TEXT("ProcGen streaming: %d instances in %d chunks of %dx%d tiles"),
+		PendingInstances.Floors.Num() + PendingInstances.Walls.Num(), StreamChunks.Num(), StreamingChunkSize, StreamingChunkSize);
+	SetActorTickEnabled(StreamChunks.Num() > 0);
+}
+
+AProcMapManager::FStreamChunk& AProcMapManager::AddStreamChunk(const FIntPoint& Coord)
+{
+	// World bounds through the full actor transform, like nav dirtying, so a rotated or scaled
+	// manager streams the chunks its viewers actually stand in
+	const int32 CS = StreamingChunkSize;
+	const FBox WorldBounds = GridRectToWorldBounds(FIntRect(Coord * CS, (Coord + FIntPoint(1, 1)) * CS));
+
+	StreamChunkLookup.Add(Coord, StreamChunks.Num());
+	FStreamChunk& Chunk = StreamChunks.AddDefaulted_GetRef();
+	Chunk.Coord = Coord;
+	Chunk.Bounds = FBox2D(FVector2D(WorldBounds.Min), FVector2D(WorldBounds.Max));
+	return Chunk;
+}
+
+int32 AProcMapManager::RefreshStreamChunks(const FIntRect& Affected)
+{
+	// Chunks are small; rebuilding each touched chunk's instance lists is simpler than patching them
+	const FProcInstanceSettings Settings = MakeInstanceSettings();
+	const int32 CS = StreamingChunkSize;
+	int32 Touched = 0;
+	for (int32 cy = Affected.Min.Y / CS; cy <= (Affected.Max.Y - 1) / CS; ++cy)
+		for (int32 cx = Affected.Min.X / CS; cx <= (Affected.Max.X - 1) / CS; ++cx)
+		{
+			const FIntPoint Coord(cx, cy);
+			const int32* Existing = StreamChunkLookup.Find(Coord);
+			FStreamChunk& Chunk = Existing ? StreamChunks[*Existing] : AddStreamChunk(Coord);
+
+			const bool bWasLoaded = Chunk.bLoaded;
+			UnloadStreamChunk(Chunk);
+			FProcInstanceBuilder::BuildRegion(Map, Settings, FIntRect(cx * CS, cy * CS, (cx + 1) * CS, (cy + 1) * CS), Chunk.Instances);
+			if (bWasLoaded) LoadStreamChunk(Chunk);
+			Touched += Chunk.Instances.Floors.Num() + Chunk.Instances.Walls.Num();
+		}
+	return Touched;
+}
+
+void AProcMapManager::ResetStreamChunks()
+{
+	for (FStreamChunk& Chunk : StreamChunks)
+	{
+		UnloadStreamChunk(Chunk);
+	}
+	StreamChunks.Reset();
+	StreamChunkLookup.Reset();
+	StreamQueue.Reset();
+}
 
-				// North edge: start at (x, y+1)
-				if (!IsFloor(Map, x, y + 1))  PlaceEdge(x, y, 0.f, FVector(0.f, S - T, 0.f));
+void AProcMapManager::UpdateStreaming()
+{
+	if (!Tileset) return;
+
+	GatherViewerLocations(StreamViewers);
+	if (StreamViewers.Num() == 0) return;
+
+	const float InSq = FMath::Square(StreamInRadius);
+	const float OutSq = FMath::Square(FMath::Max(StreamOutRadius, StreamInRadius));
+	StreamQueue.Reset();
+	for (int32 i = 0; i < StreamChunks.Num(); ++i)
+	{
+		FStreamChunk& Chunk = StreamChunks[i];
+		float DistSq = MAX_flt;
+		for (const FVector2D& Viewer : StreamViewers)
+		{
+			DistSq = FMath::Min(DistSq, (float)Chunk.Bounds.ComputeSquaredDistanceToPoint(Viewer));
+		}
+
+		if (Chunk.bLoaded)
+		{
+			if (DistSq > OutSq) UnloadStreamChunk(Chunk);
+		}
+		else if (DistSq <= InSq)
+		{
+			StreamQueue.HeapPush({ DistSq, i });
+		}
+	}
+
+	for (int32 Loads = 0; Loads < MaxChunkLoadsPerFrame && StreamQueue.Num() > 0; ++Loads)
+	{
+		FStreamRequest Request;
+		StreamQueue.HeapPop(Request, EAllowShrinking::No);
+		LoadStreamChunk(StreamChunks[Request.Chunk]);
+	}
+}
 
-				// West edge: start at (x, y), wall runs north-south
-				if (!IsFloor(Map, x - 1, y))  PlaceEdge(x, y, 90.f, FVector(0.f, 0.f, 0.f));
+void AProcMapManager::GatherViewerLocations(TArray<FVector2D>& Out) const
+{
+	Out.Reset();
+	const UWorld* World = GetWorld();
+	if (!World) return;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		if (const APawn* Pawn = PC ? PC->GetPawn() : nullptr)
+		{
+			Out.Add(FVector2D(Pawn->GetActorLocation()));
+		}
+	}
+}
 
-				// East edge: start at (x+1, y)
-				if (!IsFloor(Map, x + 1, y))  PlaceEdge(x, y, 90.f, FVector(S - T, 0.f, 0.f));
+void AProcMapManager::LoadStreamChunk(FStreamChunk& Chunk)
+{
+	if (Chunk.bLoaded) return;
+	Chunk.bLoaded = true;
+
+	if (Tileset->FloorMesh && Chunk.Instances.Floors.Num() > 0)
+	{
+		Chunk.Floor = AcquireStreamComponent(Tileset->FloorMesh);
+		Chunk.Floor->AddInstances(Chunk.Instances.Floors, /*bShouldReturnIndices*/ false);
+	}
+	if (Tileset->WallMesh && Chunk.Instances.Walls.Num() > 0)
+	{
+		Chunk.Wall = AcquireStreamComponent(Tileset->WallMesh);
+		Chunk.Wall->AddInstances(Chunk.Instances.Walls, /*bShouldReturnIndices*/ false);
+	}
+}
+
+void AProcMapManager::UnloadStreamChunk(FStreamChunk& Chunk)
+{
+	if (!Chunk.bLoaded) return;
+	Chunk.bLoaded = false;
+	ReleaseStreamComponent(Chunk.Floor);
+	ReleaseStreamComponent(Chunk.Wall);
+}
+
+UHierarchicalInstancedStaticMeshComponent* AProcMapManager::AcquireStreamComponent(UStaticMesh* Mesh)
+{
+	UHierarchicalInstancedStaticMeshComponent* HISM = FreeStreamComponents.Num() > 0 ? FreeStreamComponents.Pop(EAllowShrinking::No) : nullptr;
+	if (HISM == nullptr)
+	{
+		HISM = NewObject<UHierarchicalInstancedStaticMeshComponent>(this, NAME_None, RF_Transient);
+		HISM->SetupAttachment(RootComponent);
+		HISM->SetCollisionProfileName(TEXT("BlockAll"));
+		HISM->SetCanEverAffectNavigation(NavMode == EProcNavMode::Recast);
+		HISM->RegisterComponent();
+		StreamComponents.Add(HISM);
+	}
+	HISM->SetStaticMesh(Mesh);
+	return HISM;
+}
+
+void AProcMapManager::ReleaseStreamComponent(UHierarchicalInstancedStaticMeshComponent*& HISM)
+{
+	if (HISM == nullptr) return;
+	HISM->ClearInstances();
+	FreeStreamComponents.Add(HISM);
+	HISM = nullptr;
+}
+
+void AProcMapManager::CollectNavChunks(const FProcInstanceBatch& Batch, TSet<FIntPoint>& Out) const
+{
+	// Walls sit on the edges of walkable cells, so floor cells alone cover every chunk with geometry
+	// except where a wall edge crosses a chunk border; GridRectToWorldBounds pads by a tile for those.
+	const int32 CS = NavDirtyChunkSize;
+	for (const FIntPoint& Cell : Batch.FloorCells) Out.Add(FIntPoint(Cell.X / CS, Cell.Y / CS));
+	for (const FIntPoint& Cell : Batch.WallCells) Out.Add(FIntPoint(Cell.X / CS, Cell.Y / CS));
+}
+
+void AProcMapManager::QueueNavRebuild(const TSet<FIntPoint>& Chunks)
+{
+	const int32 CS = NavDirtyChunkSize;
+	TArray<FBox> Areas;
+	Areas.Reserve(Chunks.Num());
+	for (const FIntPoint& Chunk : Chunks)
+	{
+		Areas.Add(GridRectToWorldBounds(FIntRect(Chunk.X * CS, Chunk.Y * CS, (Chunk.X + 1) * CS, (Chunk.Y + 1) * CS)));
+	}
+	QueueNavRebuild(MoveTemp(Areas));
+}
+
+void AProcMapManager::QueueNavRebuild(TArray<FBox> Areas)
+{
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NS = World ? FNavigationSystem::GetCurrent<UNavigationSystemV1>(World) : nullptr;
+	if (!NS || Areas.Num() == 0) return;
+
+	// Nearest players first. The recast generator also sorts its pending tiles by player location;
+	// this gets the areas around players into its queue in the first batch.
+	TArray<FVector2D> Viewers;
+	GatherViewerLocations(Viewers);
+	if (Viewers.Num() > 0)
+	{
+		Algo::SortBy(Areas, [&Viewers](const FBox& Box)
+		{
+			const FBox2D Box2D(FVector2D(Box.Min), FVector2D(Box.Max));
+			double DistSq = MAX_dbl;
+			for (const FVector2D& Viewer : Viewers) DistSq = FMath::Min(DistSq, Box2D.ComputeSquaredDistanceToPoint(Viewer));
+			return DistSq;
+		});
+	}
+	for (const FBox& Box : Areas)
+	{
+		NS->AddDirtyArea(Box, ENavigationDirtyFlag::All);
+	}
+
+	// The editor rebuilds its navmesh on its own; during play, watch for the tiles to land
+	if (!World->IsGameWorld()) return;
+	if (PendingNavAreas.Num() == 0) NavQueuedSeconds = FPlatformTime::Seconds();
+	PendingNavAreas.Append(Areas);
+	if (!GetWorldTimerManager().IsTimerActive(NavPollTimer))
+	{
+		GetWorldTimerManager().SetTimer(NavPollTimer, this, &AProcMapManager::PollNavReady, 0.1f, /*bLoop*/ true);
+	}
+}
+
+void AProcMapManager::RebuildGridNav()
+{
+	FScopeLock Lock(&GridNavLock);
+	if (NavMode == EProcNavMode::Grid) GridNav.Build(Map);
+	else GridNav.Reset();
+}
+
+void AProcMapManager::SetGridNav(FGridNavGraph&& InGridNav)
+{
+	FScopeLock Lock(&GridNavLock);
+	GridNav = MoveTemp(InGridNav);
+}
+
+void AProcMapManager::UpdateGridNavRegistration()
+{
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NavSys = World && World->IsGameWorld() ? FNavigationSystem::GetCurrent<UNavigationSystemV1>(World) : nullptr;
+	AProcGridNavMesh* NavMesh = nullptr;
+	if (NavSys && NavMode == EProcNavMode::Grid)
+	{
+		// Spawns the default agent's nav data if no nav bounds made one; grid maps need none
+		NavMesh = Cast<AProcGridNavMesh>(NavSys->GetDefaultNavDataInstance(FNavigationSystem::Create));
+		if (!NavMesh)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ProcMapManager: grid nav needs AProcGridNavMesh as the default agent's NavDataClass; MoveTo won't see this map."));
+		}
+	}
+	if (GridNavMesh.Get() != NavMesh)
+	{
+		if (AProcGridNavMesh* Old = GridNavMesh.Get()) Old->RemoveGridManager(this);
+		if (NavMesh) NavMesh->AddGridManager(this);
+		GridNavMesh = NavMesh;
+	}
+}
+
+void AProcMapManager::PollNavReady()
+{
+	PendingNavAreas.RemoveAllSwap([this](const FBox& Box) { return IsNavReadyForRegion(Box); });
+	if (PendingNavAreas.Num() > 0) return;
+
+	GetWorldTimerManager().ClearTimer(NavPollTimer);
+	UE_LOG(LogTemp, Log, TEXT("ProcGen navigation ready after %.2f ms"), (FPlatformTime::Seconds() - NavQueuedSeconds) * 1000.0);
+	OnNavReady.Broadcast();
+}
+
+bool AProcMapManager::IsNavReadyForRegion(const FBox& WorldBounds) const
+{
+	if (NavMode == EProcNavMode::Grid) return GridNav.IsBuilt();
+
+	const UWorld* World = GetWorld();
+	const UNavigationSystemV1* NS = World ? FNavigationSystem::GetCurrent<UNavigationSystemV1>(World) : nullptr;
+	if (!NS) return true;
+
+	// Dirty areas reach the generators in batches; until then there's no telling which tiles they hit
+	if (NS->HasDirtyAreasQueued()) return false;
+#if WITH_RECAST
+	for (const ANavigationData* NavData : NS->NavDataSet)
+	{
+		const ARecastNavMesh* NavMesh = Cast<ARecastNavMesh>(NavData);
+		const FRecastNavMeshGenerator* NavGenerator = NavMesh ? static_cast<const FRecastNavMeshGenerator*>(NavMesh->GetGenerator()) : nullptr;
+		if (NavGenerator && NavGenerator->HasDirtyTiles(WorldBounds)) return false;
+	}
+#endif
+	return true;
+}
+
+bool AProcMapManager::IsNavReadyAt(const FVector& Location, float Radius) const
+{
+	return IsNavReadyForRegion(FBox::BuildAABB(Location, FVector(Radius)));
+}
+
+FIntPoint AProcMapManager::WorldToGrid(const FVector& World) const
+{
+	// GridToWorld is the cell's min corner, so the cell is [X, X+1) in tiles
+	const FVector Local = World - GetActorLocation();
+	return FIntPoint(FMath::FloorToInt(Local.X / TileSize), FMath::FloorToInt(Local.Y / TileSize));
+}
+
+bool AProcMapManager::FindGridPath(const FVector& Start, const FVector& End, TArray<FVector>& OutPath) const
+{
+	OutPath.Reset();
+	TArray<FIntPoint> Cells;
+	if (!Pathfinder.FindPath(WorldToGrid(Start), WorldToGrid(End), Cells)) return false;
+
+	OutPath.Reserve(Cells.Num());
+	for (const FIntPoint& Cell : Cells)
+	{
+		OutPath.Add(GridCellCenter(Cell.X, Cell.Y));
+	}
+	return true;
+}
+
+bool AProcMapManager::FindLongPath(const FVector& Start, const FVector& End, TArray<FVector>& OutFirstLeg, TArray<FVector>& OutWaypoints) const
+{
+	OutFirstLeg.Reset();
+	OutWaypoints.Reset();
+	TArray<FIntPoint> LegCells, WaypointCells;
+	if (!RoomGraph.FindPath(Pathfinder, WorldToGrid(Start), WorldToGrid(End), LegCells, WaypointCells)) return false;
+
+	for (const FIntPoint& Cell : LegCells) OutFirstLeg.Add(GridCellCenter(Cell.X, Cell.Y));
+	for (const FIntPoint& Cell : WaypointCells) OutWaypoints.Add(GridCellCenter(Cell.X, Cell.Y));
+	return true;
+}
+
+bool AProcMapManager::GetFlowFieldStep(const FVector& From, const FVector& Target, FVector& OutNext)
+{
+	FIntPoint Next;
+	if (!Pathfinder.GetNextStep(WorldToGrid(From), WorldToGrid(Target), Next)) return false;
+	OutNext = GridCellCenter(Next.X, Next.Y);
+	return true;
+}
+
+bool AProcMapManager::FindGridNavPath(const FVector& Start, const FVector& End, TArray<FVector>& OutPath) const
+{
+	OutPath.Reset();
+	TArray<FVector2D> Points;
+	{
+		FScopeLock Lock(&GridNavLock);
+		if (!GridNav.FindPath(WorldToGridNav(Start), WorldToGridNav(End), Points)) return false;
+	}
+
+	OutPath.Reserve(Points.Num());
+	for (const FVector2D& Point : Points)
+	{
+		OutPath.Add(GridNavToWorld(Point));
+	}
+	// Keep the caller's heights at the ends; grid points sit on the floor plane
+	OutPath[0] = Start;
+	OutPath.Last() = End;
+	return true;
+}
+
+bool AProcMapManager::ContainsGridNavPoint(const FVector& Location) const
+{
+	const FVector2D P = WorldToGridNav(Location);
+	FScopeLock Lock(&GridNavLock);
+	return P.X >= 0.0 && P.Y >= 0.0 && P.X < GridNav.GetWidth() && P.Y < GridNav.GetHeight();
+}
+
+bool AProcMapManager::ProjectToGridNav(const FVector& Point, const FVector& Extent, FVector& OutLocation) const
+{
+	const double FloorZ = GetActorLocation().Z;
+	if (FMath::Abs(Point.Z - FloorZ) > Extent.Z) return false;
+
+	const FVector2D P = WorldToGridNav(Point);
+	FScopeLock Lock(&GridNavLock);
+	if (GridNav.FindPoly(P) != INDEX_NONE)
+	{
+		OutLocation = FVector(Point.X, Point.Y, FloorZ);
+		return true;
+	}
+
+	// Off the walkable cells: clamp into the closest walkable cell the extent reaches, kept just inside it
+	// so the result floors back to that cell
+	const double Inset = 1e-3;
+	const int32 MinX = FMath::Max(FMath::FloorToInt(P.X - Extent.X / TileSize), 0);
+	const int32 MinY = FMath::Max(FMath::FloorToInt(P.Y - Extent.Y / TileSize), 0);
+	const int32 MaxX = FMath::Min(FMath::FloorToInt(P.X + Extent.X / TileSize), GridNav.GetWidth() - 1);
+	const int32 MaxY = FMath::Min(FMath::FloorToInt(P.Y + Extent.Y / TileSize), GridNav.GetHeight() - 1);
+	double BestDistSq = UE_DOUBLE_BIG_NUMBER;
+	FVector2D Best;
+	for (int32 Y = MinY; Y <= MaxY; ++Y)
+		for (int32 X = MinX; X <= MaxX; ++X)
+		{
+			if (GridNav.FindPoly(FIntPoint(X, Y)) == INDEX_NONE) continue;
+			const FVector2D Clamped(FMath::Clamp(P.X, X + Inset, X + 1 - Inset), FMath::Clamp(P.Y, Y + Inset, Y + 1 - Inset));
+			const double DistSq = FVector2D::DistSquared(P, Clamped);
+			if (DistSq < BestDistSq)
+			{
+				BestDistSq = DistSq;
+				Best = Clamped;
+			}
+		}
+	if (BestDistSq == UE_DOUBLE_BIG_NUMBER) return false;
+	const FVector World = GridNavToWorld(Best);
+	if (FMath::Abs(World.X - Point.X) > Extent.X || FMath::Abs(World.Y - Point.Y) > Extent.Y) return false;
+	OutLocation = FVector(World.X, World.Y, FloorZ);
+	return true;
+}
+
+bool AProcMapManager::GetRandomGridNavPoint(const FVector& Origin, float Radius, FVector& OutLocation) const
+{
+	FScopeLock Lock(&GridNavLock);
+	if (GridNav.NumPolys() == 0) return false;
+
+	if (Radius <= 0.f)
+	{
+		// Area-weighted poly, then a uniform point in it
+		int64 TotalArea = 0;
+		for (int32 i = 0; i < GridNav.NumPolys(); ++i) TotalArea += GridNav.GetPoly(i).Rect.Area();
+		int64 Pick = (int64)(FMath::FRand() * TotalArea);
+		for (int32 i = 0; i < GridNav.NumPolys(); ++i)
+		{
+			const FIntRect& Rect = GridNav.GetPoly(i).Rect;
+			Pick -= Rect.Area();
+			if (Pick < 0 || i == GridNav.NumPolys() - 1)
+			{
+				OutLocation = GridNavToWorld(FVector2D(FMath::FRandRange((double)Rect.Min.X, (double)Rect.Max.X), FMath::FRandRange((double)Rect.Min.Y, (double)Rect.Max.Y)));
+				return true;
 			}
+		}
+		return false;
 	}
 
-	// Rebuild navmesh for AI
-	if (UWorld* World = GetWorld())
+	// Rejection sampling in the disc, keeping the first walkable point connected to Origin
+	const FVector2D From = WorldToGridNav(Origin);
+	const int32 FromPoly = GridNav.FindPoly(From);
+	if (FromPoly == INDEX_NONE) return false;
+	const double R = Radius / TileSize;
+	TArray<int32> Polys;
+	for (int32 Attempt = 0; Attempt < 32; ++Attempt)
 	{
-		if (auto* NS = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World))
+		const double Angle = FMath::FRand() * UE_DOUBLE_TWO_PI;
+		const double Dist = R * FMath::Sqrt(FMath::FRand());
+		const FVector2D To = From + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Dist;
+		const int32 ToPoly = GridNav.FindPoly(To);
+		if (ToPoly == INDEX_NONE || !GridNav.FindPolyPath(FromPoly, ToPoly, From, To, Polys)) continue;
+		OutLocation = GridNavToWorld(To);
+		return true;
+	}
+	return false;
+}
+
+bool AProcMapManager::RaycastGridNav(const FVector& Start, const FVector& End, FVector& OutHit) const
+{
+	FVector2D Hit;
+	bool bHit;
+	{
+		FScopeLock Lock(&GridNavLock);
+		bHit = GridNav.Raycast(WorldToGridNav(Start), WorldToGridNav(End), Hit);
+	}
+	OutHit = GridNavToWorld(Hit);
+	return bHit;
+}
+
+void AProcMapManager::FinishApply(const TSet<FIntPoint>* ChangedNavChunks)
+{
+	// Invalidate navigation only where geometry came or went; tiles are rebuilt asynchronously
+	TSet<FIntPoint> AppliedNavChunks;
+	if (NavMode == EProcNavMode::Grid)
+	{
+		// Already built next to the map; only clear out what Recast still has from earlier maps
+		QueueNavRebuild(NavChunks);
+	}
+	else
+	{
+		CollectNavChunks(PendingInstances, AppliedNavChunks);
+		if (ChangedNavChunks)
 		{
-			NS->Build();
+			QueueNavRebuild(*ChangedNavChunks);
 		}
+		else
+		{
+			TSet<FIntPoint> Dirty = NavChunks;
+			Dirty.Append(AppliedNavChunks);
+			QueueNavRebuild(Dirty);
+		}
+	}
+	NavChunks = MoveTemp(AppliedNavChunks);
+	PendingInstances.Reset();
+	UpdateGridNavRegistration();
+	// Pathfinder and RoomGraph were built next to the map, on the worker for async generation
+	UE_LOG(LogTemp, Log, TEXT("ProcGen room graph: %d regions, %d portal nodes in %.2f ms"),
+		RoomGraph.NumRegions(), RoomGraph.NumNodes(), RoomGraph.GetBuildSeconds() * 1000.0);
+
+	UE_LOG(LogTemp, Log, TEXT("ProcGen complete. Seed=%d, Cells=%d, Rooms=%d"), AppliedSeed, Map.CountNonEmpty(), Map.Rooms.Num());
+	if (Map.Validation.bValidated)
+	{
+		const FMapValidation& V = Map.Validation;
+		UE_LOG(LogTemp, Log, TEXT("ProcGen validation: %.1f%% reachable, %d component(s), start room %d %s goal room %d (layout seed %d, %d attempt(s), %d repair corridor(s))"),
+			V.ReachablePercent, V.NumComponents, V.StartRoom, V.bStartReachesGoal ? TEXT("reaches") : TEXT("does not reach"),
+			V.GoalRoom, V.Seed, V.Attempts, V.RepairCorridors);
+		if (!V.bPassed)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ProcGen validation failed: start must reach goal and %.1f%% of walkable cells must be reachable."), AppliedParams.MinReachablePercent);
+		}
+	}
+	if (Map.IsChunked())
+	{
+		UE_LOG(LogTemp, Log, TEXT("ProcGen storage: %d chunks, %llu bytes/chunk, %.2f MB total"),
+			Map.Chunks.NumChunks(), (uint64)Map.Chunks.GetBytesPerChunk(), Map.GetAllocatedSize() / (1024.0 * 1024.0));
+	}
+
+	if (NavMode == EProcNavMode::Grid)
+	{
+		UE_LOG(LogTemp, Log, TEXT("ProcGen grid nav: %d polys, %d portals, built in %.2f ms"),
+			GridNav.NumPolys(), GridNav.NumLinks(), GridNav.GetBuildSeconds() * 1000.0);
+	}
+
+	// Networked games: the server publishes what this map came from, clients report what they ended up with
+	const ENetMode NetMode = GetNetMode();
+	MapHash = NetMode != NM_Standalone ? UProcMapNetComponent::ComputeMapHash(Map) : 0;
+	NetPayload.Reset();
+	if (NetMode == NM_Client)
+	{
+		if (UProcMapNetComponent* Net = UProcMapNetComponent::FindLocal(GetWorld())) Net->ReportMap(this);
+	}
+	else if (NetMode != NM_Standalone)
+	{
+		// From the applied map, not Seed/Params: those may already name a newer one still generating
+		NetState.Seed = AppliedSeed;
+		NetState.Params = AppliedParams;
+		NetState.GeneratorVersion = UMapGenerator::GeneratorVersion;
+		ForceNetUpdate();
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("ProcGen complete. Seed=%d, Cells=%d, Rooms=%d"), Seed, Map.Cells.Num(), Map.Rooms.Num());
+	OnMapGenerated.Broadcast(AppliedSeed);
+	if (NavMode == EProcNavMode::Grid) OnNavReady.Broadcast();
 }
\ No newline at end of file
@@ -4,8 +4,68 @@
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "ProcTypes.h"
 #include "ProcTileset.h"
+#include "MapGenerator.h"
+#include "ProcInstanceBuilder.h"
+#include "ProcInstanceSlots.h"
+#include "GridNavGraph.h"
+#include "GridPathfinder.h"
+#include "RoomPortalGraph.h"
+#include "Tasks/Task.h"
 #include "ProcMapManager.generated.h"
 
+struct FProcMapNetPayload;
+class AProcGridNavMesh;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMapGenerated, int32, GeneratedSeed);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnMapNavReady);
+
+UENUM(BlueprintType)
+enum class EProcNavMode : uint8
+{
+	Recast, // navmesh voxelized from the floor/wall collision
+	Grid    // rectangles and portals built straight from the map; geometry doesn't affect navigation
+};
+// Grid mode turns off CanEverAffectNavigation and registers the map with the world's AProcGridNavMesh
+// (the default agent's nav data, see DefaultEngine.ini), which answers MoveTo and other
+// UNavigationSystemV1 queries over the map from the grid nav graph.
+
+/** Map cache settings of a manager, copied out so a worker never reads the actor. */
+struct FProcMapCacheUse
+{
+	bool bMemory = false;
+	bool bDisk = false;
+	SIZE_T BudgetBytes = 0;
+};
+
+/** One async generation: its inputs, its output and the generator it runs on. */
+struct FProcMapAsyncJob
+{
+	FProcGenJobState State;
+	FProcGenParams Params;
+	int32 Seed = 0;
+	FMapData Result;
+	FProcInstanceSettings InstanceSettings;
+	FProcInstanceBatch Instances;
+	FGridNavGraph GridNav;
+	FGridPathfinder Pathfinder;
+	FRoomPortalGraph RoomGraph;
+	FProcMapCacheUse CacheUse;
+	bool bUseBakedMaps = false;
+	bool bBuildGridNav = false;
+	bool bFromCache = false; // Result was filled from a baked map or the map cache, the generator is skipped
+	UMapGenerator* Generator = nullptr; // kept alive by AProcMapManager::AsyncGenerators
+};
+
+/** What clients need to generate the server's map themselves. */
+USTRUCT()
+struct FProcMapNetState
+{
+	GENERATED_BODY()
+	UPROPERTY() int32 Seed = 0;
+	UPROPERTY() FProcGenParams Params; // effective params (tileset overrides applied)
+	UPROPERTY() int32 GeneratorVersion = 0; // 0 until the server has applied a map
+};
+
 UCLASS()
 class AProcMapManager : public AActor
 {
@@ -18,11 +78,145 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen") TObjectPtr<UProcTileset> Tileset;
 	UPROPERTY(EditAnywhere, Category="ProcGen") float TileSize = 400.f; // cm per tile
 
+	/** During play, run the data pass on a worker thread. Editor (CallInEditor) generation is always synchronous. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen") bool bAsyncGeneration = true;
+
+	/**
+	 * Max instances (floors + walls) added to the HISMs per frame during play; 0 commits everything at once.
+	 * Editor generation ignores the budget.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen", meta=(ClampMin="0")) int32 InstanceCommitBudgetPerFrame = 0;
+
+	/**
+	 * When regenerating over an existing map, diff old and new instances: unchanged cells keep their
+	 * instance, stale ones are parked and new ones reuse parked slots. Otherwise everything is rebuilt.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen") bool bDiffInstancesOnRegenerate = true;
+
+	/**
+	 * Load maps baked by the ProcMapBake commandlet (Content/ProcGen/Baked) when one matches Seed,
+	 * effective Params and generator version. Checked before the map cache.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen|Cache") bool bUseBakedMaps = true;
+	/** Reuse maps generated before for the same Seed, effective Params and generator version instead of running the generator. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen|Cache") bool bUseMapCache = true;
+	/** Also keep cached maps under Saved/ProcGenCache, so they survive level restarts and new sessions. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen|Cache") bool bUseDiskMapCache = true;
+	/** In-memory cache budget, shared by every manager in the process. */
+	UPROPERTY(EditAnywhere, Category="ProcGen|Cache", meta=(ClampMin="0")) int32 MapCacheBudgetMB = 256;
+
+	/** During play, split instances into per-chunk HISM pairs and only keep chunks near player pawns loaded. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen|Streaming") bool bStreamChunks = false;
+	UPROPERTY(EditAnywhere, Category="ProcGen|Streaming", meta=(ClampMin="4")) int32 StreamingChunkSize = 32; // tiles per side
+	UPROPERTY(EditAnywhere, Category="ProcGen|Streaming") float StreamInRadius = 8000.f;   // cm; load chunks closer than this
+	UPROPERTY(EditAnywhere, Category="ProcGen|Streaming") float StreamOutRadius = 10000.f; // cm; unload beyond this (hysteresis)
+	UPROPERTY(EditAnywhere, Category="ProcGen|Streaming", meta=(ClampMin="1")) int32 MaxChunkLoadsPerFrame = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ProcGen|Navigation") EProcNavMode NavMode = EProcNavMode::Recast;
+
+	/** Tiles per side of the areas invalidated for navigation; only areas the old or new map covers are rebuilt. */
+	UPROPERTY(EditAnywhere, Category="ProcGen|Navigation", meta=(ClampMin="4")) int32 NavDirtyChunkSize = 32;
+
+	/** Fires on the game thread once a generated map has been applied (sync or async). */
+	UPROPERTY(BlueprintAssignable, Category="ProcGen") FOnMapGenerated OnMapGenerated;
+
+	/** Fires during play once the navmesh has caught up with everything the last generation or edit invalidated. */
+	UPROPERTY(BlueprintAssignable, Category="ProcGen|Navigation") FOnMapNavReady OnNavReady;
+
+	/** Generates the current Seed/Params. Calling it again cancels any in-flight async job. */
 	UFUNCTION(CallInEditor, BlueprintCallable) void Generate();
 	UFUNCTION(CallInEditor, BlueprintCallable) void Clear();
 
+	/** Sets cells in [Min, Max) to Type (Empty, Floor or Door) and rebuilds only the affected walls, instances and nav. */
+	UFUNCTION(BlueprintCallable, Category="ProcGen") void CarveRegion(FIntPoint Min, FIntPoint Max, ECellType Type = ECellType::Floor);
+
+	/**
+	 * Call after editing cells of Region through GetMutableMap(). Re-derives walls and open edges for Region
+	 * plus a one-tile border and updates only the instances (and their collision) whose cells changed.
+	 */
+	void RegenerateRegion(const FIntRect& Region);
+
+	const FMapData& GetMap() const { return Map; }
+	FMapData& GetMutableMap() { return Map; }
+
+	/** 0..1 progress of the current generation, 1 when idle. For loading screens. */
+	UFUNCTION(BlueprintPure, Category="ProcGen") float GetGenerationProgress() const;
+	UFUNCTION(BlueprintPure, Category="ProcGen") bool IsGenerating() const { return ActiveJob.IsValid() || bCommittingInstances; }
+
+	/** Server: what the last applied map was generated from; clients regenerate when it changes. */
+	const FProcMapNetState& GetNetState() const { return NetState; }
+	/** Networked games: UProcMapNetComponent::ComputeMapHash of the applied map, 0 otherwise. */
+	uint64 GetMapHash() const { return MapHash; }
+	/** Client: the applied map is (or should be) the one the server replicated, so its hash can be checked. */
+	bool IsNetMapReady() const { return NetState.GeneratorVersion != 0 && Seed == NetState.Seed && !IsGenerating(); }
+	/** Client: replaces the map with one sent by the server and rebuilds instances and nav for it. */
+	void ApplyReceivedMap(FMapData&& InMap);
+	/** Server: the applied map as sent to clients that generated a different one; built on first use, shared by every client. */
+	TSharedPtr<const FProcMapNetPayload> GetNetPayload();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Params with the tileset's overrides applied; what the generator and the map keys actually see. */
+	FProcGenParams MakeGenParams() const;
+	/** Placement of this manager's instances: origin, tile sizes, wall height, which meshes the tileset has. */
+	FProcInstanceSettings MakeInstanceSettings() const;
+
+	/** Connectivity report of the last generation (edits since then aren't re-validated). */
+	UFUNCTION(BlueprintPure, Category="ProcGen") FMapValidation GetMapValidation() const { return Map.Validation; }
+
+	/** True when no navmesh tile overlapping WorldBounds is waiting to be rebuilt. */
+	UFUNCTION(BlueprintPure, Category="ProcGen|Navigation") bool IsNavReadyForRegion(const FBox& WorldBounds) const;
+	UFUNCTION(BlueprintPure, Category="ProcGen|Navigation") bool IsNavReadyAt(const FVector& Location, float Radius = 1000.f) const;
+
+	/**
+	 * Grid nav mode: world-space path from Start to End over the grid nav graph. False if either end is off the map or unreachable.
+	 * Same paths MoveTo follows through AProcGridNavMesh.
+	 */
+	UFUNCTION(BlueprintCallable, Category="ProcGen|Navigation") bool FindGridNavPath(const FVector& Start, const FVector& End, TArray<FVector>& OutPath) const;
+	const FGridNavGraph& GetGridNav() const { return GridNav; }
+
+	// Grid nav queries for AProcGridNavMesh. They may come from the nav system's async query threads, so
+	// they and FindGridNavPath hold GridNavLock, and every change to GridNav takes it too.
+	/** True if Location is over the grid nav graph's map rectangle, walkable or not; false while there's no graph. */
+	bool ContainsGridNavPoint(const FVector& Location) const;
+	/** Closest walkable floor point within Extent of Point. */
+	bool ProjectToGridNav(const FVector& Point, const FVector& Extent, FVector& OutLocation) const;
+	/** Random walkable floor point, uniform by area. With Radius > 0 it lies within Radius of Origin and is reachable from it. */
+	bool GetRandomGridNavPoint(const FVector& Origin, float Radius, FVector& OutLocation) const;
+	/** True if the segment leaves walkable cells, with OutHit (on the floor plane) where it does. */
+	bool RaycastGridNav(const FVector& Start, const FVector& End, FVector& OutHit) const;
+
+	/** Shortest cell path (Jump Point Search) between the cells under Start and End, as cell-center world points. */
+	UFUNCTION(BlueprintCallable, Category="ProcGen|Navigation") bool FindGridPath(const FVector& Start, const FVector& End, TArray<FVector>& OutPath) const;
+
+	/**
+	 * Center of the next cell from From towards Target, read from a flow field cached per target cell.
+	 * Cheap for many agents chasing the same target. False if unreachable or already in Target's cell.
+	 */
+	UFUNCTION(BlueprintCallable, Category="ProcGen|Navigation") bool GetFlowFieldStep(const FVector& From, const FVector& Target, FVector& OutNext);
+
+	/**
+	 * Long-range path over the room/corridor portal graph. OutWaypoints are the portal cells to pass
+	 * through, ending at End's cell; OutFirstLeg is the exact cell path to the first of them.
+	 * Re-query when the first waypoint is reached.
+	 */
+	UFUNCTION(BlueprintCallable, Category="ProcGen|Navigation") bool FindLongPath(const FVector& Start, const FVector& End, TArray<FVector>& OutFirstLeg, TArray<FVector>& OutWaypoints) const;
+
+	FGridPathfinder& GetPathfinder() { return Pathfinder; }
+	const FRoomPortalGraph& GetRoomGraph() const { return RoomGraph; }
+
+	/** World position of the min corner of cell (X, Y), where its corner-pivot floor mesh sits. */
+	UFUNCTION(BlueprintPure, Category="ProcGen") FVector GridToWorld(int32 X, int32 Y) const { return GetActorLocation() + FVector(X*TileSize, Y*TileSize, 0.f); }
+	/** World position of the center of cell (X, Y); what the path queries return for agents to walk to. */
+	UFUNCTION(BlueprintPure, Category="ProcGen") FVector GridCellCenter(int32 X, int32 Y) const { return GetActorLocation() + FVector((X + 0.5f)*TileSize, (Y + 0.5f)*TileSize, 0.f); }
+	/** Cell containing World. */
+	UFUNCTION(BlueprintPure, Category="ProcGen") FIntPoint WorldToGrid(const FVector& World) const;
+
+	virtual void Tick(float DeltaSeconds) override;
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
 	UHierarchicalInstancedStaticMeshComponent* FloorHISM = nullptr;
@@ -31,8 +225,121 @@ private:
 	UPROPERTY(Transient)
 	TObjectPtr<class UMapGenerator> Generator;
 
+	// One generator per async job so a cancelled job still winding down never shares state with a new one
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UMapGenerator>> AsyncGenerators;
+	TArray<UMapGenerator*> FreeAsyncGenerators;
+
+	TSharedPtr<FProcMapAsyncJob, ESPMode::ThreadSafe> ActiveJob;
+	TArray<UE::Tasks::FTask> PendingTasks;
+
+	// Only the seed and params replicate; clients generate locally and UProcMapNetComponent checks the result
+	UPROPERTY(ReplicatedUsing=OnRep_NetState)
+	FProcMapNetState NetState;
+	uint64 MapHash = 0;
+	TSharedPtr<const FProcMapNetPayload> NetPayload; // for MapHash; dropped when another map is applied
+
+	UFUNCTION() void OnRep_NetState();
+
 	FMapData Map;
+	int32 AppliedSeed = 0; // seed Map was generated from; Seed may already name the next one
+	FProcGenParams AppliedParams; // effective params Map was generated with, likewise
+	FGridNavGraph GridNav;
+	mutable FCriticalSection GridNavLock;
+	TWeakObjectPtr<AProcGridNavMesh> GridNavMesh; // the nav data we're registered with in grid mode
+	FGridPathfinder Pathfinder;
+	FRoomPortalGraph RoomGraph;
+
+	// Which instance shows which cell/edge in FloorHISM/WallHISM, for in-place updates
+	FProcInstanceSlots FloorSlots;
+	FProcInstanceSlots WallSlots;
+	FProcInstanceSettings AppliedInstanceSettings; // settings the tracked instances were placed with
 
 	void EnsureComponents();
-	FVector GridToWorld(int32 X, int32 Y) const { return GetActorLocation() + FVector(X*TileSize, Y*TileSize, 0.f); }
+	void ClearInstances();
+	int32 ApplyRegionInstances(const FIntRect& Affected);
+	FBox GridRectToWorldBounds(const FIntRect& Rect) const;
+	void StartAsyncGeneration();
+	void CancelAsyncGeneration();
+	void OnAsyncGenerationFinished(const TSharedPtr<FProcMapAsyncJob, ESPMode::ThreadSafe>& Job);
+	FProcMapCacheUse MakeCacheUse() const;
+	// Thread-safe: async jobs load baked maps, look up and store on their worker
+	static bool LoadBakedMap(const FProcGenParams& GenParams, int32 InSeed, FMapData& OutMap);
+	static bool LoadCachedMap(const FProcMapCacheUse& CacheUse, const FProcGenParams& GenParams, int32 InSeed, FMapData& OutMap);
+	static void StoreCachedMap(const FProcMapCacheUse& CacheUse, const FProcGenParams& GenParams, int32 InSeed, const FMapData& InMap);
+
+	// Instance commit: transforms are built up front, then added in bulk (optionally over several frames)
+	FProcInstanceBatch PendingInstances;
+	int32 CommittedFloors = 0;
+	int32 CommittedWalls = 0;
+	int32 CommitFrames = 0;
+	double CommitSeconds = 0.0;
+	bool bCommittingInstances = false;
+
+	// Chunk streaming: each chunk owns its instances and, while loaded, a pooled floor/wall HISM pair
+	struct FStreamChunk
+	{
+		FIntPoint Coord;
+		FBox2D Bounds; // world XY, compared against viewer pawn locations
+		FProcInstanceBatch Instances;
+		UHierarchicalInstancedStaticMeshComponent* Floor = nullptr;
+		UHierarchicalInstancedStaticMeshComponent* Wall = nullptr;
+		bool bLoaded = false;
+	};
+	struct FStreamRequest
+	{
+		float DistSq;
+		int32 Chunk;
+		bool operator<(const FStreamRequest& Other) const { return DistSq < Other.DistSq; }
+	};
+	TArray<FStreamChunk> StreamChunks;
+	TMap<FIntPoint, int32> StreamChunkLookup;
+	TArray<FStreamRequest> StreamQueue; // rebuilt every update, nearest first
+	TArray<FVector2D> StreamViewers;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>> StreamComponents; // every pooled component
+	TArray<UHierarchicalInstancedStaticMeshComponent*> FreeStreamComponents;
+
+	void BuildStreamChunks();
+	FStreamChunk& AddStreamChunk(const FIntPoint& Coord);
+	int32 RefreshStreamChunks(const FIntRect& Affected);
+	void ResetStreamChunks();
+	void UpdateStreaming();
+	void LoadStreamChunk(FStreamChunk& Chunk);
+	void UnloadStreamChunk(FStreamChunk& Chunk);
+	UHierarchicalInstancedStaticMeshComponent* AcquireStreamComponent(UStaticMesh* Mesh);
+	void ReleaseStreamComponent(UHierarchicalInstancedStaticMeshComponent*& HISM);
+
+	void GatherViewerLocations(TArray<FVector2D>& Out) const;
+
+	// Navigation: the nav system's async generator rebuilds the tiles under the areas we dirty
+	TSet<FIntPoint> NavChunks;    // nav chunks the applied map has geometry in
+	TArray<FBox> PendingNavAreas; // dirtied and not yet rebuilt
+	FTimerHandle NavPollTimer;
+	double NavQueuedSeconds = 0.0;
+
+	void CollectNavChunks(const FProcInstanceBatch& Batch, TSet<FIntPoint>& Out) const;
+	void QueueNavRebuild(const TSet<FIntPoint>& Chunks);
+	void QueueNavRebuild(TArray<FBox> Areas);
+	void PollNavReady();
+	/** Registers with the world's AProcGridNavMesh in grid mode during play, unregisters otherwise. */
+	void UpdateGridNavRegistration();
+	/** GridNav from Map in grid mode, empty otherwise. */
+	void RebuildGridNav();
+	void SetGridNav(FGridNavGraph&& InGridNav);
+
+	/** Puts the new Map and PendingInstances into the world: stream chunks or instance commit, then FinishApply. */
+	void ApplyMap(bool bAllowTimeSlicing);
+	void ApplyInstances(bool bAllowTimeSlicing);
+	bool CanSyncInstances(const FProcInstanceSettings& Settings) const;
+	void SyncInstances(const FProcInstanceSettings& Settings, TSet<FIntPoint>& OutChangedNavChunks);
+	void BeginInstanceCommit(bool bAllowTimeSlicing);
+	bool CommitInstanceSlice(int32 Budget);
+	void EndInstanceCommit(bool bCompleted);
+	/** ChangedNavChunks: nav chunks whose geometry changed, or null for everything the old and new map cover. */
+	void FinishApply(const TSet<FIntPoint>* ChangedNavChunks = nullptr);
+	// Grid nav units: cell (X, Y) spans [X, X+1), and its corner (X, Y) lands on GridToWorld(X, Y) like the floor mesh pivots
+	FVector GridNavToWorld(const FVector2D& P) const { return GetActorLocation() + FVector(P.X * TileSize, P.Y * TileSize, 0.f); }
+	FVector2D WorldToGridNav(const FVector& W) const { const FVector L = W - GetActorLocation(); return FVector2D(L.X / TileSize, L.Y / TileSize); }
 };
@@ -0,0 +1,272 @@
+#include "ProcMapNetComponent.h"
+#include "ProcMapManager.h"
+#include "ProcMapCache.h"
+#include "ProcMapFile.h"
+#include "EngineUtils.h"
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Hash/CityHash.h"
+#include "Misc/Compression.h"
+
+UProcMapNetComponent::UProcMapNetComponent()
+{
+	SetIsReplicatedByDefault(true);
+
+	// Ticks only while sending maps or holding back reports
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+uint64 UProcMapNetComponent::ComputeMapHash(const FMapData& Map)
+{
+	const int32 Width = Map.GetWidth(), Height = Map.GetHeight();
+	const int32 Size[2] = { Width, Height };
+	uint64 Hash = CityHash64(reinterpret_cast<const char*>(Size), sizeof(Size));
+
+	// Row by row so dense and chunked maps with the same cells hash the same
+	TArray<uint8> Row;
+	Row.SetNumUninitialized(Width);
+	for (int32 y = 0; y < Height; ++y)
+	{
+		const uint8* Types = nullptr;
+		if (Map.IsChunked())
+		{
+			for (int32 x = 0; x < Width; ++x) Row[x] = (uint8)Map.Get(x, y);
+			Types = Row.GetData();
+		}
+		else
+		{
+			Types = Map.Grid.Types.GetData() + y * Width;
+		}
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Types), Width, Hash);
+	}
+
+	for (const FRoom& Room : Map.Rooms)
+	{
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&Room.Bounds), sizeof(FIntRect), Hash);
+	}
+	return Hash;
+}
+
+UProcMapNetComponent* UProcMapNetComponent::FindLocal(const UWorld* World)
+{
+	const APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+	return PC ? PC->FindComponentByClass<UProcMapNetComponent>() : nullptr;
+}
+
+TSharedPtr<const FProcMapNetPayload> UProcMapNetComponent::MakePayload(const FMapData& Map, const FProcMapNetState& State, uint64 MapHash)
+{
+	TArray<uint8> Raw;
+	FProcMapFile::Write(Map, State.Seed, FProcMapCacheKey::Make(State.Params, State.Seed).ParamsHash, Raw);
+
+	const TSharedRef<FProcMapNetPayload> Payload = MakeShared<FProcMapNetPayload>();
+	Payload->RawBytes = Raw.Num();
+	Payload->MapHash = MapHash;
+	int32 CompressedBytes = FCompression::CompressMemoryBound(NAME_Oodle, Raw.Num());
+	Payload->Compressed.SetNumUninitialized(CompressedBytes);
+	if (!FCompression::CompressMemory(NAME_Oodle, Payload->Compressed.GetData(), CompressedBytes, Raw.GetData(), Raw.Num())) return nullptr;
+	Payload->Compressed.SetNum(CompressedBytes);
+	return Payload;
+}
+
+void UProcMapNetComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Maps generated before this component replicated haven't been reported yet
+	if (GetNetMode() != NM_Client) return;
+	for (TActorIterator<AProcMapManager> It(GetWorld()); It; ++It)
+	{
+		ReportMap(*It);
+	}
+}
+
+void UProcMapNetComponent::ReportMap(AProcMapManager* Manager)
+{
+	if (!Manager || !Manager->IsNetMapReady()) return;
+	const uint64 ParamsHash = FProcMapCacheKey::Make(Manager->MakeGenParams(), Manager->Seed).ParamsHash;
+	ServerReportMapHash(Manager, Manager->Seed, ParamsHash, Manager->GetMapHash());
+}
+
+bool UProcMapNetComponent::ServerReportMapHash_Validate(AProcMapManager* Manager, int32 MapSeed, uint64 ParamsHash, uint64 MapHash)
+{
+	// A manager from another world can only come from a tampered client
+	return !Manager || Manager->GetWorld() == GetWorld();
+}
+
+void UProcMapNetComponent::ServerReportMapHash_Implementation(AProcMapManager* Manager, int32 MapSeed, uint64 ParamsHash, uint64 MapHash)
+{
+	if (!Manager) return;
+
+	// Every mismatch costs a transfer, so each manager is handled at most once per interval. A report
+	// arriving sooner isn't dropped: it may be the only one the client sends for that map.
+	const double Now = FPlatformTime::Seconds();
+	FManagerReports& Entry = Reports.FindOrAdd(Manager);
+	if (Now - Entry.LastHandled < ReportIntervalSeconds)
+	{
+		Entry.bHeld = true;
+		Entry.Seed = MapSeed;
+		Entry.ParamsHash = ParamsHash;
+		Entry.MapHash = MapHash;
+		SetComponentTickEnabled(true);
+		return;
+	}
+	Entry.LastHandled = Now;
+	HandleReport(Manager, MapSeed, ParamsHash, MapHash);
+}
+
+bool UProcMapNetComponent::FlushHeldReports()
+{
+	const double Now = FPlatformTime::Seconds();
+	bool bAnyHeld = false;
+	for (auto It = Reports.CreateIterator(); It; ++It)
+	{
+		AProcMapManager* Manager = It.Key().Get();
+		if (!Manager)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		FManagerReports& Entry = It.Value();
+		if (!Entry.bHeld) continue;
+		if (Now - Entry.LastHandled < ReportIntervalSeconds)
+		{
+			bAnyHeld = true;
+			continue;
+		}
+		Entry.bHeld = false;
+		Entry.LastHandled = Now;
+		HandleReport(Manager, Entry.Seed, Entry.ParamsHash, Entry.MapHash);
+	}
+	return bAnyHeld;
+}
+
+void UProcMapNetComponent::HandleReport(AProcMapManager* Manager, int32 MapSeed, uint64 ParamsHash, uint64 MapHash)
+{
+	// Reports for an older map are stale; the client regenerates and reports again
+	const FProcMapNetState& State = Manager->GetNetState();
+	if (MapSeed != State.Seed || ParamsHash != FProcMapCacheKey::Make(State.Params, State.Seed).ParamsHash) return;
+
+	if (MapHash == Manager->GetMapHash())
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("ProcGen net: %s matches %s (Seed=%d)"), *GetOwner()->GetName(), *Manager->GetName(), MapSeed);
+		return;
+	}
+	UE_LOG(LogTemp, Warning, TEXT("ProcGen net: %s generated a different map for %s (Seed=%d, hash %016llx, ours %016llx); sending ours"),
+		*GetOwner()->GetName(), *Manager->GetName(), MapSeed, MapHash, Manager->GetMapHash());
+	QueueTransfer(Manager);
+}
+
+void UProcMapNetComponent::QueueTransfer(AProcMapManager* Manager)
+{
+	const TSharedPtr<const FProcMapNetPayload> Payload = Manager->GetNetPayload();
+	if (!Payload.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("ProcGen net: failed to compress the map of %s"), *Manager->GetName());
+		return;
+	}
+
+	// Queued copies of an older map of the same manager are dropped; one already on the wire has to finish.
+	// The same map already queued or on the wire isn't sent twice.
+	for (int32 i = Outgoing.Num() - 1; i >= 0; --i)
+	{
+		if (Outgoing[i].Manager != Manager) continue;
+		if (Outgoing[i].Payload == Payload) return;
+		if (Outgoing[i].SentBytes == 0) Outgoing.RemoveAt(i);
+	}
+
+	FOutgoingMap& Out = Outgoing.AddDefaulted_GetRef();
+	Out.Manager = Manager;
+	Out.Payload = Payload;
+	UE_LOG(LogTemp, Log, TEXT("ProcGen net: sending %s to %s, %d bytes (%d uncompressed)"), *Manager->GetName(), *GetOwner()->GetName(), Payload->Compressed.Num(), Payload->RawBytes);
+	SetComponentTickEnabled(true);
+}
+
+int32 UProcMapNetComponent::GetChunkBudget() const
+{
+	// Listen server's own player: nothing goes over a wire
+	UNetConnection* Connection = GetOwner()->GetNetConnection();
+	if (!Connection) return MaxUnackedChunks;
+
+	// Hold off while the connection has more queued than its rate allows, and keep the channel's
+	// unacknowledged reliable bunches well below the reliable buffer, which closes the connection when full
+	if (!Connection->IsNetReady(/*Saturate*/ false)) return 0;
+	const UActorChannel* Channel = Connection->FindActorChannelRef(GetOwner());
+	return Channel ? FMath::Max(MaxUnackedChunks - Channel->NumOutRec, 0) : 0;
+}
+
+void UProcMapNetComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const bool bReportsHeld = FlushHeldReports();
+	const int32 ChunkBytes = FMath::Clamp(TransferChunkBytes, 1, MaxTransferChunkBytes);
+	for (int32 Budget = GetChunkBudget(); Budget > 0 && Outgoing.Num() > 0; )
+	{
+		FOutgoingMap& Out = Outgoing[0];
+		const TArray<uint8>& Compressed = Out.Payload->Compressed;
+		if (Out.SentBytes == 0)
+		{
+			// A manager gone before its first byte is skipped; mid-transfer the client just drops it
+			if (!Out.Manager.IsValid())
+			{
+				Outgoing.RemoveAt(0);
+				continue;
+			}
+			ClientBeginMapTransfer(Out.Manager.Get(), Out.Payload->RawBytes, Compressed.Num());
+			--Budget;
+		}
+		const int32 Bytes = FMath::Min(ChunkBytes, Compressed.Num() - Out.SentBytes);
+		ClientReceiveMapChunk(TArray<uint8>(Compressed.GetData() + Out.SentBytes, Bytes));
+		Out.SentBytes += Bytes;
+		--Budget;
+		if (Out.SentBytes == Compressed.Num()) Outgoing.RemoveAt(0);
+	}
+	if (Outgoing.Num() == 0 && !bReportsHeld) SetComponentTickEnabled(false);
+}
+
+void UProcMapNetComponent::ClientBeginMapTransfer_Implementation(AProcMapManager* Manager, int32 RawBytes, int32 CompressedBytes)
+{
+	IncomingManager = Manager;
+	IncomingRawBytes = RawBytes;
+	IncomingCompressedBytes = CompressedBytes;
+	Incoming.Reset(CompressedBytes);
+}
+
+void UProcMapNetComponent::ClientReceiveMapChunk_Implementation(const TArray<uint8>& Chunk)
+{
+	if (Incoming.Num() + Chunk.Num() > IncomingCompressedBytes) return; // no transfer begun, or a corrupt one
+	Incoming.Append(Chunk);
+	if (Incoming.Num() == IncomingCompressedBytes) FinishIncomingTransfer();
+}
+
+void UProcMapNetComponent::FinishIncomingTransfer()
+{
+	AProcMapManager* Manager = IncomingManager.Get();
+	TArray<uint8> Raw;
+	Raw.SetNumUninitialized(IncomingRawBytes);
+	const bool bUncompressed = FCompression::UncompressMemory(NAME_Oodle, Raw.GetData(), Raw.Num(), Incoming.GetData(), Incoming.Num());
+	Incoming.Empty();
+	IncomingManager.Reset();
+	IncomingCompressedBytes = 0;
+	if (!Manager) return;
+
+	FProcMapFileView View;
+	FMapData Map;
+	if (!bUncompressed || !View.OpenMemory(Raw.GetData(), Raw.Num()) || !FProcMapFile::Read(View, Map))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ProcGen net: received an unreadable map for %s"), *Manager->GetName());
+		return;
+	}
+
+	// The replicated state may have moved on while this was in flight
+	const FProcMapFileHeader& Header = View.GetHeader();
+	if (Header.Seed != Manager->Seed || Header.ParamsHash != FProcMapCacheKey::Make(Manager->MakeGenParams(), Manager->Seed).ParamsHash)
+	{
+		UE_LOG(LogTemp, Log, TEXT("ProcGen net: dropping a map for %s, Seed=%d is no longer current"), *Manager->GetName(), Header.Seed);
+		return;
+	}
+	Manager->ApplyReceivedMap(MoveTemp(Map));
+}
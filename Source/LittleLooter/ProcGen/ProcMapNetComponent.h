@@ -0,0 +1,96 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ProcTypes.h"
+#include "ProcMapNetComponent.generated.h"
+
+class AProcMapManager;
+struct FProcMapNetState;
+
+/** A map as sent over the wire: an Oodle-compressed .pgbin. Built once per applied map and shared by every transfer. */
+struct FProcMapNetPayload
+{
+	TArray<uint8> Compressed;
+	int32 RawBytes = 0;
+	uint64 MapHash = 0;
+};
+
+/**
+ * Map sync for one player, living on their PlayerController (ALooterGameModeBase adds it on login).
+ * Managers only replicate Seed, Params and generator version; each client generates locally and
+ * reports a hash of the result here. On a mismatch the server streams its map to that client as a
+ * compressed .pgbin in reliable chunks, paced by how much the connection still has queued.
+ */
+UCLASS(ClassGroup=(ProcGen), meta=(BlueprintSpawnableComponent))
+class UProcMapNetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	UProcMapNetComponent();
+
+	/** Chunks are TArray RPC parameters, so they can't exceed net.MaxRepArraySize (2048 by default). */
+	static constexpr int32 MaxTransferChunkBytes = 2048;
+
+	UPROPERTY(EditAnywhere, Category="ProcGen|Net", meta=(ClampMin="256", ClampMax="2048")) int32 TransferChunkBytes = MaxTransferChunkBytes;
+	/** Reliable chunks left unacknowledged on the channel before sending waits; the reliable buffer holds 256 in all. */
+	UPROPERTY(EditAnywhere, Category="ProcGen|Net", meta=(ClampMin="1", ClampMax="128")) int32 MaxUnackedChunks = 64;
+	/**
+	 * Seconds between two map hash reports handled for one manager, so a client can't make the server resend at will.
+	 * A report arriving sooner is held, replacing any held before it, and handled once the interval is up.
+	 */
+	UPROPERTY(EditAnywhere, Category="ProcGen|Net", meta=(ClampMin="0")) float ReportIntervalSeconds = 0.5f;
+
+	/** Hash of the cell types and room rects; open edges, room ids and storage layout don't affect it. */
+	static uint64 ComputeMapHash(const FMapData& Map);
+
+	/** Client: the local player's component, or null before the server has added it. */
+	static UProcMapNetComponent* FindLocal(const UWorld* World);
+
+	/** Server: compresses Map as described by State, for AProcMapManager::GetNetPayload. Null if compression fails. */
+	static TSharedPtr<const FProcMapNetPayload> MakePayload(const FMapData& Map, const FProcMapNetState& State, uint64 MapHash);
+
+	/** Client: tells the server which map Manager ended up with, if it holds the replicated one. */
+	void ReportMap(AProcMapManager* Manager);
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	UFUNCTION(Server, Reliable, WithValidation) void ServerReportMapHash(AProcMapManager* Manager, int32 MapSeed, uint64 ParamsHash, uint64 MapHash);
+	UFUNCTION(Client, Reliable) void ClientBeginMapTransfer(AProcMapManager* Manager, int32 RawBytes, int32 CompressedBytes);
+	UFUNCTION(Client, Reliable) void ClientReceiveMapChunk(const TArray<uint8>& Chunk);
+
+	void HandleReport(AProcMapManager* Manager, int32 MapSeed, uint64 ParamsHash, uint64 MapHash);
+	/** Server: handles held reports whose interval is up; true while some are still held. */
+	bool FlushHeldReports();
+	void QueueTransfer(AProcMapManager* Manager);
+	void FinishIncomingTransfer();
+	/** Server: how many more chunks the owning connection takes this tick. */
+	int32 GetChunkBudget() const;
+
+	// Server: maps waiting to go out, front one in progress
+	struct FOutgoingMap
+	{
+		TWeakObjectPtr<AProcMapManager> Manager;
+		TSharedPtr<const FProcMapNetPayload> Payload;
+		int32 SentBytes = 0;
+	};
+	TArray<FOutgoingMap> Outgoing;
+
+	// Server: report rate limit per manager, with the latest report held back while it applies
+	struct FManagerReports
+	{
+		double LastHandled = -UE_DOUBLE_BIG_NUMBER;
+		bool bHeld = false;
+		int32 Seed = 0;
+		uint64 ParamsHash = 0;
+		uint64 MapHash = 0;
+	};
+	TMap<TWeakObjectPtr<AProcMapManager>, FManagerReports> Reports;
+
+	// Client: map being received
+	TWeakObjectPtr<AProcMapManager> IncomingManager;
+	TArray<uint8> Incoming;
+	int32 IncomingRawBytes = 0;
+	int32 IncomingCompressedBytes = 0;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Generation passes that draw random numbers. Part of the stream key, so append only. */
+enum class EProcGenPass : uint32
+{
+	Rooms = 1,
+	Connect = 2,
+};
+
+/**
+ * Counter-based random stream: the N-th number is a hash of (key, N), and the key is a hash of
+ * (Seed, chunk, pass). Streams for different chunks and passes are independent, so any number of
+ * them can run in parallel in any order and still produce the same values.
+ * Mirrors the parts of FRandomStream the generator uses.
+ */
+struct FProcRandom
+{
+	FProcRandom(int32 Seed, const FIntPoint& Chunk, EProcGenPass Pass)
+		: Key(Mix(Mix(uint64(uint32(Seed)) | (uint64(Pass) << 32)) ^ (uint64(uint32(Chunk.X)) | (uint64(uint32(Chunk.Y)) << 32))))
+	{
+	}
+
+	/** SplitMix64 finalizer. */
+	static FORCEINLINE uint64 Mix(uint64 Z)
+	{
+		Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBull;
+		return Z ^ (Z >> 31);
+	}
+
+	FORCEINLINE uint32 GetUnsignedInt() { return uint32(Mix(Key + (++Counter) * 0x9E3779B97F4A7C15ull) >> 32); }
+
+	/** [0, 1) */
+	FORCEINLINE float GetFraction() { return (GetUnsignedInt() >> 8) * (1.f / 16777216.f); }
+
+	/** [Min, Max] inclusive; Min if the range is empty, like FRandomStream. */
+	FORCEINLINE int32 RandRange(int32 Min, int32 Max)
+	{
+		const int64 Range = int64(Max) - Min + 1;
+		return Range > 0 ? Min + int32((uint64(GetUnsignedInt()) * uint64(Range)) >> 32) : Min;
+	}
+
+	FORCEINLINE float FRandRange(float Min, float Max) { return Min + (Max - Min) * GetFraction(); }
+
+	/** Seed for an FRandomStream, for serial code that already takes one. */
+	FORCEINLINE int32 NextSeed() { return int32(GetUnsignedInt()); }
+
+private:
+	uint64 Key;
+	uint64 Counter = 0;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "ProcTypes.h"
 #include "ProcTileset.generated.h"
 
 UCLASS(BlueprintType)
@@ -19,4 +20,11 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	float TileSize = 100.f;
+
+	/** Biomes can pick their own room layout instead of the manager's Params.Layout. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(InlineEditConditionToggle))
+	bool bOverrideLayout = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(EditCondition="bOverrideLayout"))
+	ERoomLayout Layout = ERoomLayout::Rejection;
 };
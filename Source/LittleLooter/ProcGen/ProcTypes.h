@@ -1,11 +1,62 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "ChunkedCellGrid.h"
 #include "ProcTypes.generated.h"
 
 UENUM(BlueprintType)
 enum class ECellType : uint8 { Empty, Floor, Wall, Door };
 
+/** Per-cell bits kept in the Flags plane. The low nibble marks walkable cells' edges that face a non-walkable cell. */
+enum class ECellFlags : uint8
+{
+	None      = 0,
+	OpenSouth = 1 << 0, // (x, y-1) is not walkable
+	OpenNorth = 1 << 1, // (x, y+1)
+	OpenWest  = 1 << 2, // (x-1, y)
+	OpenEast  = 1 << 3, // (x+1, y)
+	OpenEdges = OpenSouth | OpenNorth | OpenWest | OpenEast,
+};
+ENUM_CLASS_FLAGS(ECellFlags);
+
+UENUM(BlueprintType)
+enum class EMapStorage : uint8
+{
+	Dense,   // flat row-major grid, best for small/medium maps
+	Chunked  // 32x32 chunks allocated on demand, for huge mostly-empty maps
+};
+
+UENUM(BlueprintType)
+enum class ERoomLayout : uint8
+{
+	Rejection,   // RoomAttempts random rectangles, overlapping ones are dropped
+	PoissonDisk, // rooms centered on Bridson Poisson-disk samples, shrunk to fit their neighbors
+	Bsp          // one room per leaf of a binary space partition, nothing rejected; ignores RoomAttempts
+};
+
+UENUM(BlueprintType)
+enum class ECorridorMode : uint8
+{
+	LShape, // straight Manhattan L between room centers
+	AStar   // routed over a cost field that reuses existing corridors and avoids other rooms
+};
+
+UENUM(BlueprintType)
+enum class ERoomConnectivity : uint8
+{
+	Sequential,         // room i-1 to room i in placement order, plus ExtraCorridors random pairs
+	MinimumSpanningTree // MST of the k-nearest-neighbor graph of room centers, plus LoopFraction of the shorter leftovers
+};
+
+UENUM(BlueprintType)
+enum class EMapValidation : uint8
+{
+	Off,
+	Report, // fill FMapData::Validation only
+	Repair, // carve a corridor from every stranded region to the start room
+	Reject  // regenerate from a derived seed, up to MaxValidationRetries times, until the targets are met
+};
+
 USTRUCT(BlueprintType)
 struct FProcGenParams
 {
@@ -17,17 +68,139 @@ struct FProcGenParams
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) int32 MinRoomSize = 4;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) int32 MaxRoomSize = 10;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) int32 ExtraCorridors = 6; // extra connections
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) ERoomLayout Layout = ERoomLayout::Rejection; // PoissonDisk uses RoomAttempts as a room cap; Bsp fills every leaf
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0")) float RoomSpacing = 0.f; // PoissonDisk: min distance between room centers, 0 = from the room sizes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) EMapStorage Storage = EMapStorage::Dense;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) bool bParallelChunks = false; // rooms per chunk on all cores from per-chunk random streams (ignores Layout); same map for any thread count
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "8")) int32 GenerationChunkSize = 64; // bParallelChunks: tiles per chunk side
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) ECorridorMode CorridorMode = ECorridorMode::LShape;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) ERoomConnectivity Connectivity = ERoomConnectivity::Sequential;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1")) int32 NeighborCount = 6; // MST mode: candidate neighbors per room
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "1")) float LoopFraction = 0.15f; // MST mode: share of non-tree candidates kept as loops
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) EMapValidation Validation = EMapValidation::Report;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "100")) float MinReachablePercent = 95.f; // of walkable cells, from the start room
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0")) int32 MaxValidationRetries = 4; // Reject mode
 };
 
-USTRUCT()
-struct FCell
+/**
+ * Dense row-major cell storage. The type plane is always present (one byte per cell);
+ * the RoomId and Flags planes are optional and only allocated when requested.
+ */
+struct FCellGrid
 {
-	GENERATED_BODY()
-	FCell() {}
-	FCell(int32 InX, int32 InY, ECellType InType) : X(InX), Y(InY), Type(InType) {}
-	int32 X = 0;
-	int32 Y = 0;
-	ECellType Type = ECellType::Empty;
+	void Init(int32 InWidth, int32 InHeight, bool bWithRoomIds = false, bool bWithFlags = false)
+	{
+		Width = FMath::Max(InWidth, 0);
+		Height = FMath::Max(InHeight, 0);
+		const int32 Num = Width * Height;
+
+		// SetNum* with no shrinking keeps the old allocation around for the next generation
+		Types.SetNumUninitialized(Num, EAllowShrinking::No);
+		FMemory::Memset(Types.GetData(), (uint8)ECellType::Empty, Num);
+
+		RoomIds.SetNumUninitialized(bWithRoomIds ? Num : 0, EAllowShrinking::No);
+		for (int32& Id : RoomIds) Id = INDEX_NONE;
+
+		Flags.SetNumUninitialized(bWithFlags ? Num : 0, EAllowShrinking::No);
+		if (bWithFlags) FMemory::Memzero(Flags.GetData(), Num);
+	}
+
+	/** Empties the grid but keeps every plane's capacity. */
+	void Reset()
+	{
+		Width = Height = 0;
+		Types.Reset();
+		RoomIds.Reset();
+		Flags.Reset();
+	}
+
+	FORCEINLINE int32 Num() const { return Types.Num(); }
+	FORCEINLINE bool IsInBounds(int32 X, int32 Y) const { return X >= 0 && Y >= 0 && X < Width && Y < Height; }
+	FORCEINLINE int32 ToIndex(int32 X, int32 Y) const { return Y * Width + X; }
+	FORCEINLINE FIntPoint ToCoord(int32 Index) const { return FIntPoint(Index % Width, Index / Width); }
+
+	FORCEINLINE bool HasRoomIds() const { return RoomIds.Num() > 0; }
+	FORCEINLINE bool HasFlags() const { return Flags.Num() > 0; }
+
+	/** Out-of-bounds reads are Empty, which is what every neighbor test wants. */
+	FORCEINLINE ECellType Get(int32 X, int32 Y) const
+	{
+		return IsInBounds(X, Y) ? (ECellType)Types[ToIndex(X, Y)] : ECellType::Empty;
+	}
+
+	/** Out-of-bounds writes are dropped. */
+	FORCEINLINE void Set(int32 X, int32 Y, ECellType Type)
+	{
+		if (IsInBounds(X, Y)) Types[ToIndex(X, Y)] = (uint8)Type;
+	}
+
+	FORCEINLINE int32 GetRoomId(int32 X, int32 Y) const
+	{
+		return (HasRoomIds() && IsInBounds(X, Y)) ? RoomIds[ToIndex(X, Y)] : INDEX_NONE;
+	}
+
+	FORCEINLINE void SetRoomId(int32 X, int32 Y, int32 RoomId)
+	{
+		if (HasRoomIds() && IsInBounds(X, Y)) RoomIds[ToIndex(X, Y)] = RoomId;
+	}
+
+	FORCEINLINE uint8 GetFlags(int32 X, int32 Y) const
+	{
+		return (HasFlags() && IsInBounds(X, Y)) ? Flags[ToIndex(X, Y)] : 0;
+	}
+
+	FORCEINLINE void SetFlags(int32 X, int32 Y, uint8 InFlags)
+	{
+		if (HasFlags() && IsInBounds(X, Y)) Flags[ToIndex(X, Y)] = InFlags;
+	}
+
+	FORCEINLINE bool IsEmpty(int32 X, int32 Y) const { return Get(X, Y) == ECellType::Empty; }
+
+	/** Floor or Door; false outside the grid. */
+	FORCEINLINE bool IsWalkable(int32 X, int32 Y) const
+	{
+		const ECellType T = Get(X, Y);
+		return T == ECellType::Floor || T == ECellType::Door;
+	}
+
+	/** True if any of the 4 neighbors is walkable. */
+	FORCEINLINE bool IsNextToWalkable(int32 X, int32 Y) const
+	{
+		return IsWalkable(X + 1, Y) || IsWalkable(X - 1, Y) || IsWalkable(X, Y + 1) || IsWalkable(X, Y - 1);
+	}
+
+	/** Calls Fn(NX, NY) for each in-bounds 4-neighbor (E, W, N, S). */
+	template <typename FuncType>
+	FORCEINLINE void ForEachNeighbor4(int32 X, int32 Y, FuncType&& Fn) const
+	{
+		if (X + 1 < Width)  Fn(X + 1, Y);
+		if (X > 0)          Fn(X - 1, Y);
+		if (Y + 1 < Height) Fn(X, Y + 1);
+		if (Y > 0)          Fn(X, Y - 1);
+	}
+
+	int32 CountNonEmpty() const
+	{
+		int32 Count = 0;
+		for (const uint8 T : Types) Count += (T != (uint8)ECellType::Empty);
+		return Count;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Types.GetAllocatedSize() + RoomIds.GetAllocatedSize() + Flags.GetAllocatedSize();
+	}
+
+	void Serialize(FArchive& Ar)
+	{
+		Ar << Width << Height << Types << RoomIds << Flags;
+	}
+
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<uint8> Types;   // ECellType per cell
+	TArray<int32> RoomIds; // optional: index into FMapData::Rooms, INDEX_NONE for corridors/walls
+	TArray<uint8> Flags;   // optional: per-cell bit flags
 };
 
 USTRUCT()
@@ -36,12 +209,145 @@ struct FRoom
 	GENERATED_BODY()
 	FIntRect Bounds; // inclusive min, exclusive max (like Rect: [Min, Max))
 	TArray<FIntPoint> DoorCells;
+
+	FIntPoint GetCenter() const { return FIntPoint((Bounds.Min.X + Bounds.Max.X) / 2, (Bounds.Min.Y + Bounds.Max.Y) / 2); }
+
+	friend FArchive& operator<<(FArchive& Ar, FRoom& Room) { return Ar << Room.Bounds << Room.DoorCells; }
+};
+
+/**
+ * Connectivity report filled by the validation pass. Start is room 0 and goal is the room whose
+ * center is farthest from it, until layouts place explicit start/goal rooms.
+ */
+USTRUCT(BlueprintType)
+struct FMapValidation
+{
+	GENERATED_BODY()
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) bool bValidated = false;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) bool bPassed = false;      // start reaches goal and ReachablePercent >= target
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) bool bStartReachesGoal = false;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) float ReachablePercent = 0.f; // walkable cells connected to the start room
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) int32 NumComponents = 0;   // 4-connected walkable regions
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) int32 WalkableCells = 0;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) int32 StartRoom = INDEX_NONE;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) int32 GoalRoom = INDEX_NONE;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) int32 RepairCorridors = 0; // Repair mode
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) int32 Attempts = 0;        // layouts tried (Reject mode can try several)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly) int32 Seed = 0;            // seed of the layout that was kept
+
+	friend FArchive& operator<<(FArchive& Ar, FMapValidation& V)
+	{
+		return Ar << V.bValidated << V.bPassed << V.bStartReachesGoal << V.ReachablePercent << V.NumComponents << V.WalkableCells
+			<< V.StartRoom << V.GoalRoom << V.RepairCorridors << V.Attempts << V.Seed;
+	}
+};
+
+/** Wall-clock seconds per stage of the last UMapGenerator::Run, summed over Reject-mode attempts. */
+struct FMapGenStats
+{
+	double RoomsSeconds = 0.0;
+	double CorridorsSeconds = 0.0;
+	double ValidationSeconds = 0.0; // occupancy bits plus validation (and repair)
+	double WallsSeconds = 0.0;
+	double TotalSeconds = 0.0;
 };
 
 USTRUCT()
 struct FMapData
 {
 	GENERATED_BODY()
-	TMap<FIntPoint, FCell> Cells; // key = (X,Y)
+	FCellGrid Grid;          // used when Storage == Dense
+	FChunkedCellGrid Chunks; // used when Storage == Chunked
+	EMapStorage Storage = EMapStorage::Dense;
 	TArray<FRoom> Rooms;
+	FMapValidation Validation;
+	FMapGenStats Stats; // set by UMapGenerator::Run; not serialized, and Reset leaves it alone
+
+	/** Clears contents but keeps grid and room capacity for the next Run. */
+	void Reset()
+	{
+		Grid.Reset();
+		Chunks.Reset();
+		Rooms.Reset();
+		Validation = FMapValidation();
+	}
+
+	void InitStorage(EMapStorage InStorage, int32 InWidth, int32 InHeight, bool bWithRoomIds = false, bool bWithFlags = false)
+	{
+		Storage = InStorage;
+		Width = FMath::Max(InWidth, 0);
+		Height = FMath::Max(InHeight, 0);
+		if (IsChunked()) Chunks.Init(Width, Height, bWithRoomIds, bWithFlags);
+		else Grid.Init(Width, Height, bWithRoomIds, bWithFlags);
+	}
+
+	// Storage-independent cell access. Out-of-bounds reads are Empty and writes are dropped.
+	FORCEINLINE bool IsChunked() const { return Storage == EMapStorage::Chunked; }
+	FORCEINLINE int32 GetWidth() const { return Width; }
+	FORCEINLINE int32 GetHeight() const { return Height; }
+	FORCEINLINE bool IsInBounds(int32 X, int32 Y) const { return X >= 0 && Y >= 0 && X < Width && Y < Height; }
+
+	FORCEINLINE ECellType Get(int32 X, int32 Y) const { return IsChunked() ? (ECellType)Chunks.GetType(X, Y) : Grid.Get(X, Y); }
+	FORCEINLINE void Set(int32 X, int32 Y, ECellType Type) { if (IsChunked()) Chunks.SetType(X, Y, (uint8)Type); else Grid.Set(X, Y, Type); }
+	FORCEINLINE int32 GetRoomId(int32 X, int32 Y) const { return IsChunked() ? Chunks.GetRoomId(X, Y) : Grid.GetRoomId(X, Y); }
+	FORCEINLINE void SetRoomId(int32 X, int32 Y, int32 RoomId) { if (IsChunked()) Chunks.SetRoomId(X, Y, RoomId); else Grid.SetRoomId(X, Y, RoomId); }
+	FORCEINLINE uint8 GetFlags(int32 X, int32 Y) const { return IsChunked() ? Chunks.GetFlags(X, Y) : Grid.GetFlags(X, Y); }
+	FORCEINLINE void SetFlags(int32 X, int32 Y, uint8 InFlags) { if (IsChunked()) Chunks.SetFlags(X, Y, InFlags); else Grid.SetFlags(X, Y, InFlags); }
+
+	FORCEINLINE bool IsEmpty(int32 X, int32 Y) const { return Get(X, Y) == ECellType::Empty; }
+	FORCEINLINE bool IsWalkable(int32 X, int32 Y) const
+	{
+		const ECellType T = Get(X, Y);
+		return T == ECellType::Floor || T == ECellType::Door;
+	}
+
+	/**
+	 * Calls Fn(X, Y, ECellType) for every non-empty cell. Dense storage walks rows in order;
+	 * chunked storage walks allocated chunks only, in allocation order.
+	 */
+	template <typename FuncType>
+	void ForEachCell(FuncType&& Fn) const
+	{
+		if (IsChunked())
+		{
+			Chunks.ForEachCell([&Fn](int32 X, int32 Y, uint8 Type) { Fn(X, Y, (ECellType)Type); });
+			return;
+		}
+		for (int32 y = 0; y < Grid.Height; ++y)
+		{
+			const uint8* Row = Grid.Types.GetData() + y * Grid.Width;
+			for (int32 x = 0; x < Grid.Width; ++x)
+			{
+				if (Row[x] != (uint8)ECellType::Empty) Fn(x, y, (ECellType)Row[x]);
+			}
+		}
+	}
+
+	int32 CountNonEmpty() const
+	{
+		if (!IsChunked()) return Grid.CountNonEmpty();
+		int32 Count = 0;
+		ForEachCell([&Count](int32, int32, ECellType) { ++Count; });
+		return Count;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Grid.GetAllocatedSize() + Chunks.GetAllocatedSize() + Rooms.GetAllocatedSize();
+	}
+
+	/** Whole map, both storages included. Used by the map cache; not a stable file format across generator versions. */
+	void Serialize(FArchive& Ar)
+	{
+		uint8 StorageByte = (uint8)Storage;
+		Ar << StorageByte << Width << Height;
+		Storage = (EMapStorage)StorageByte;
+		Grid.Serialize(Ar);
+		Chunks.Serialize(Ar);
+		Ar << Rooms << Validation;
+	}
+
+private:
+	int32 Width = 0;
+	int32 Height = 0;
 };
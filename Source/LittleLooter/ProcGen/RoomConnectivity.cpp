@@ -0,0 +1,133 @@
+#include "RoomConnectivity.h"
+
+static FORCEINLINE bool EdgeLess(const FRoomEdge& X, const FRoomEdge& Y)
+{
+	if (X.Length != Y.Length) return X.Length < Y.Length;
+	if (X.A != Y.A) return X.A < Y.A;
+	return X.B < Y.B;
+}
+
+void FRoomConnectivity::FindCandidates(const TArray<FIntPoint>& Centers, int32 K)
+{
+	const int32 Num = Centers.Num();
+	FIntPoint Min = Centers[0], Max = Centers[0];
+	for (const FIntPoint& C : Centers)
+	{
+		Min = Min.ComponentMin(C);
+		Max = Max.ComponentMax(C);
+	}
+
+	// About two rooms per bucket
+	const int32 Area = FMath::Max(1, (Max.X - Min.X + 1) * (Max.Y - Min.Y + 1));
+	const int32 BucketSize = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(2.f * Area / Num)));
+	const int32 BucketsX = (Max.X - Min.X) / BucketSize + 1;
+	const int32 BucketsY = (Max.Y - Min.Y) / BucketSize + 1;
+	const auto BucketOf = [&](const FIntPoint& C) { return ((C.Y - Min.Y) / BucketSize) * BucketsX + (C.X - Min.X) / BucketSize; };
+
+	// Counting sort of rooms into buckets
+	BucketStart.Init(0, BucketsX * BucketsY + 1);
+	for (const FIntPoint& C : Centers) ++BucketStart[BucketOf(C) + 1];
+	for (int32 b = 1; b < BucketStart.Num(); ++b) BucketStart[b] += BucketStart[b - 1];
+	BucketItems.SetNumUninitialized(Num, EAllowShrinking::No);
+	{
+		TArray<int32> Fill(BucketStart.GetData(), BucketsX * BucketsY);
+		for (int32 i = 0; i < Num; ++i) BucketItems[Fill[BucketOf(Centers[i])]++] = i;
+	}
+
+	Candidates.Reset();
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const FIntPoint& C = Centers[i];
+		const int32 BX = (C.X - Min.X) / BucketSize;
+		const int32 BY = (C.Y - Min.Y) / BucketSize;
+		const int32 MaxRing = FMath::Max3(BX, BucketsX - 1 - BX, FMath::Max(BY, BucketsY - 1 - BY));
+
+		// Grow square rings of buckets until the K-th nearest found so far is closer than anything
+		// the next ring could hold (every cell of ring r+1 is at least r*BucketSize away)
+		Nearest.Reset();
+		for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+		{
+			for (int32 y = BY - Ring; y <= BY + Ring; ++y)
+			{
+				if (y < 0 || y >= BucketsY) continue;
+				const bool bEdgeRow = y == BY - Ring || y == BY + Ring;
+				for (int32 x = BX - Ring; x <= BX + Ring; x += (bEdgeRow || Ring == 0) ? 1 : 2 * Ring)
+				{
+					if (x < 0 || x >= BucketsX) continue;
+					const int32 Bucket = y * BucketsX + x;
+					for (int32 Item = BucketStart[Bucket]; Item < BucketStart[Bucket + 1]; ++Item)
+					{
+						const int32 j = BucketItems[Item];
+						if (j == i) continue;
+						const int32 Length = FMath::Abs(Centers[j].X - C.X) + FMath::Abs(Centers[j].Y - C.Y);
+						Nearest.Add({ FMath::Min(i, j), FMath::Max(i, j), Length });
+					}
+				}
+			}
+			if (Nearest.Num() >= K)
+			{
+				Nearest.Sort(EdgeLess);
+				if (Nearest[K - 1].Length <= Ring * BucketSize) break;
+			}
+		}
+		Nearest.Sort(EdgeLess);
+		for (int32 n = 0; n < FMath::Min(K, Nearest.Num()); ++n) Candidates.Add(Nearest[n]);
+	}
+
+	// Each close pair usually shows up from both ends
+	Candidates.Sort(EdgeLess);
+	int32 Unique = 0;
+	for (int32 e = 0; e < Candidates.Num(); ++e)
+	{
+		if (Unique > 0 && Candidates[e].A == Candidates[Unique - 1].A && Candidates[e].B == Candidates[Unique - 1].B) continue;
+		Candidates[Unique++] = Candidates[e];
+	}
+	Candidates.SetNum(Unique, EAllowShrinking::No);
+}
+
+void FRoomConnectivity::Build(const TArray<FIntPoint>& Centers, int32 K, float LoopFraction, TArray<FRoomEdge>& OutEdges)
+{
+	OutEdges.Reset();
+	Spare.Reset();
+	NumMstEdges = 0;
+	const int32 Num = Centers.Num();
+	if (Num < 2) return;
+
+	FindCandidates(Centers, FMath::Clamp(K, 1, Num - 1));
+
+	// Kruskal: candidates are already sorted shortest first
+	Sets.Init(Num);
+	for (const FRoomEdge& Edge : Candidates)
+	{
+		if (Sets.Union(Edge.A, Edge.B)) OutEdges.Add(Edge);
+		else Spare.Add(Edge);
+	}
+
+	// Clusters too far apart for the kNN graph: chain them left to right
+	if (Sets.GetNumSets() > 1)
+	{
+		TArray<int32> Leftmost;
+		TArray<int32> RootToRep;
+		RootToRep.Init(INDEX_NONE, Num);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			int32& Rep = RootToRep[Sets.Find(i)];
+			if (Rep == INDEX_NONE || Centers[i].X < Centers[Rep].X) Rep = i;
+		}
+		for (const int32 Rep : RootToRep)
+		{
+			if (Rep != INDEX_NONE) Leftmost.Add(Rep);
+		}
+		Leftmost.Sort([&Centers](int32 L, int32 R) { return Centers[L].X != Centers[R].X ? Centers[L].X < Centers[R].X : L < R; });
+		for (int32 r = 1; r < Leftmost.Num(); ++r)
+		{
+			const int32 A = Leftmost[r - 1], B = Leftmost[r];
+			Sets.Union(A, B);
+			OutEdges.Add({ FMath::Min(A, B), FMath::Max(A, B), FMath::Abs(Centers[A].X - Centers[B].X) + FMath::Abs(Centers[A].Y - Centers[B].Y) });
+		}
+	}
+	NumMstEdges = OutEdges.Num();
+
+	const int32 NumLoops = FMath::FloorToInt(FMath::Clamp(LoopFraction, 0.f, 1.f) * Spare.Num());
+	for (int32 e = 0; e < NumLoops; ++e) OutEdges.Add(Spare[e]);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "UnionFind.h"
+
+/** Candidate or chosen connection between two rooms, by index. Length is the Manhattan distance between centers. */
+struct FRoomEdge
+{
+	int32 A;
+	int32 B;
+	int32 Length;
+};
+
+/**
+ * Picks which rooms to connect: a k-nearest-neighbor graph of room centers (found through a
+ * uniform spatial hash), its minimum spanning tree (Kruskal), plus the shortest remaining edges
+ * as loops. O(n k log(n k)) overall, so it stays cheap for tens of thousands of rooms.
+ */
+struct FRoomConnectivity
+{
+	/**
+	 * Fills OutEdges with MST edges first (shortest first), then loop edges. LoopFraction is the
+	 * share of the remaining candidate edges kept as loops, shortest first. If the kNN graph isn't
+	 * connected, the leftover pieces are joined in order of their leftmost room.
+	 */
+	void Build(const TArray<FIntPoint>& Centers, int32 K, float LoopFraction, TArray<FRoomEdge>& OutEdges);
+
+	int32 GetNumMstEdges() const { return NumMstEdges; }
+
+private:
+	void FindCandidates(const TArray<FIntPoint>& Centers, int32 K);
+
+	// Reused across builds
+	TArray<int32> BucketStart; // prefix offsets into BucketItems, one past the end per bucket
+	TArray<int32> BucketItems;
+	TArray<FRoomEdge> Candidates;
+	TArray<FRoomEdge> Nearest; // per-room scratch
+	TArray<FRoomEdge> Spare;   // candidates Kruskal skipped, loop edges come from these
+	FUnionFind Sets;
+	int32 NumMstEdges = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+struct FProcGenJobState;
+
+/** Running totals for one layout strategy, to compare strategies over the same seed range. */
+struct FRoomLayoutStats
+{
+	int32 Runs = 0;
+	int64 Rooms = 0;        // rooms placed
+	int64 Attempts = 0;     // rooms offered to TryAddRoom, placed or not
+	int64 RoomCells = 0;    // floor cells covered by rooms, for density
+	double Seconds = 0.0;
+
+	// Last run only
+	int32 LastRooms = 0;
+	int32 LastAttempts = 0;
+	double LastSeconds = 0.0;
+};
+
+/** What a layout strategy can do to the map being generated. */
+struct FRoomLayoutContext
+{
+	/** Adds the room unless it overlaps (with a one-tile gap) a placed one. */
+	TFunctionRef<bool(const FIntRect&)> TryAddRoom;
+	FProcGenJobState* Job = nullptr;
+
+	bool IsCancelled() const;
+	void ReportProgress(float Progress) const; // 0..1 of the room step
+};
+
+/**
+ * Step 1 of map generation: where the rooms go. Strategies only decide rectangles; stamping,
+ * overlap tests and the stats below are handled by the generator around PlaceRooms.
+ * Implementations keep their scratch buffers between runs and are not thread-safe.
+ */
+class IRoomLayoutStrategy
+{
+public:
+	virtual ~IRoomLayoutStrategy() = default;
+
+	virtual const TCHAR* GetName() const = 0;
+
+	/** Offers rooms through Context.TryAddRoom. False if the job was cancelled. */
+	virtual bool PlaceRooms(const FProcGenParams& Params, FRandomStream& Rand, const FRoomLayoutContext& Context) = 0;
+
+	const FRoomLayoutStats& GetStats() const { return Stats; }
+	FRoomLayoutStats& GetMutableStats() { return Stats; }
+	void ResetStats() { Stats = FRoomLayoutStats(); }
+
+private:
+	FRoomLayoutStats Stats;
+};
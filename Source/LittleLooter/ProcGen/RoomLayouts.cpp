@@ -0,0 +1,113 @@
+#include "RoomLayouts.h"
+#include "MapGenerator.h"
+
+bool FRoomLayoutContext::IsCancelled() const
+{
+	return Job && Job->IsCancelled();
+}
+
+void FRoomLayoutContext::ReportProgress(float Progress) const
+{
+	if (Job) Job->SetProgress(0.4f * FMath::Min(Progress, 1.f));
+}
+
+bool FRejectionRoomLayout::PlaceRooms(const FProcGenParams& Params, FRandomStream& Rand, const FRoomLayoutContext& Context)
+{
+	for (int32 i = 0; i < Params.RoomAttempts; ++i)
+	{
+		if ((i & 63) == 0)
+		{
+			if (Context.IsCancelled()) return false;
+			Context.ReportProgress(float(i) / Params.RoomAttempts);
+		}
+		const int32 W = Rand.RandRange(Params.MinRoomSize, Params.MaxRoomSize);
+		const int32 H = Rand.RandRange(Params.MinRoomSize, Params.MaxRoomSize);
+		const int32 X = Rand.RandRange(1, Params.Width - W - 2);
+		const int32 Y = Rand.RandRange(1, Params.Height - H - 2);
+		Context.TryAddRoom(FIntRect(X, Y, X + W, Y + H));
+	}
+	return true;
+}
+
+bool FPoissonDiskRoomLayout::PlaceRooms(const FProcGenParams& Params, FRandomStream& Rand, const FRoomLayoutContext& Context)
+{
+	// Default spacing fits two average rooms side by side with a wall between; larger rooms shrink to fit
+	const float Spacing = Params.RoomSpacing > 0.f ? Params.RoomSpacing : (Params.MinRoomSize + Params.MaxRoomSize) * 0.5f + 2.f;
+	Sampler.Init(FIntRect(1, 1, Params.Width - 1, Params.Height - 1), Spacing);
+
+	FIntPoint Center;
+	for (int32 i = 0; i < Params.RoomAttempts && Sampler.Next(Rand, Center); ++i)
+	{
+		if ((i & 63) == 0)
+		{
+			if (Context.IsCancelled()) return false;
+			Context.ReportProgress(float(i) / Params.RoomAttempts);
+		}
+		int32 W = Rand.RandRange(Params.MinRoomSize, Params.MaxRoomSize);
+		int32 H = Rand.RandRange(Params.MinRoomSize, Params.MaxRoomSize);
+		for (;;)
+		{
+			// Same bounds as rejection sampling: X in [1, Width - W - 2]
+			const int32 X = FMath::Clamp(Center.X - W / 2, 1, Params.Width - W - 2);
+			const int32 Y = FMath::Clamp(Center.Y - H / 2, 1, Params.Height - H - 2);
+			if (Context.TryAddRoom(FIntRect(X, Y, X + W, Y + H))) break;
+			if (W <= Params.MinRoomSize && H <= Params.MinRoomSize) break;
+			W = FMath::Max(W - 1, Params.MinRoomSize);
+			H = FMath::Max(H - 1, Params.MinRoomSize);
+		}
+	}
+	return true;
+}
+
+bool FBspRoomLayout::PlaceRooms(const FProcGenParams& Params, FRandomStream& Rand, const FRoomLayoutContext& Context)
+{
+	// A leaf holds a room plus a one-tile margin on its max sides, so rooms in neighboring leaves
+	// always keep a gap. Leaves are split while larger than the largest room needs. Every leaf gets
+	// a room: the area already bounds their number, and a cap would fill leaves depth-first, i.e.
+	// one corner of the map.
+	const int32 MinLeaf = FMath::Max(Params.MinRoomSize, 1) + 1;
+	const int32 MaxLeaf = FMath::Max(Params.MaxRoomSize + 1, MinLeaf);
+	const FIntRect Area(1, 1, Params.Width - 1, Params.Height - 1);
+	const float ExpectedLeaves = FMath::Max(1.f, float(Area.Width()) * Area.Height() / FMath::Square((MinLeaf + MaxLeaf) * 0.5f));
+
+	Stack.Reset();
+	if (Area.Width() >= MinLeaf && Area.Height() >= MinLeaf) Stack.Add(Area);
+	int32 Leaves = 0;
+	while (Stack.Num() > 0)
+	{
+		const FIntRect Leaf = Stack.Pop(EAllowShrinking::No);
+		const int32 W = Leaf.Width(), H = Leaf.Height();
+		const bool bCanSplitX = W > MaxLeaf && W >= 2 * MinLeaf;
+		const bool bCanSplitY = H > MaxLeaf && H >= 2 * MinLeaf;
+		if (bCanSplitX || bCanSplitY)
+		{
+			// Cut across the longer side at a random position that leaves both halves room-sized
+			const bool bCutX = bCanSplitX && (!bCanSplitY || W > H || (W == H && Rand.RandRange(0, 1) == 0));
+			FIntRect Low = Leaf, High = Leaf;
+			if (bCutX)
+			{
+				Low.Max.X = High.Min.X = Leaf.Min.X + Rand.RandRange(MinLeaf, W - MinLeaf);
+			}
+			else
+			{
+				Low.Max.Y = High.Min.Y = Leaf.Min.Y + Rand.RandRange(MinLeaf, H - MinLeaf);
+			}
+			Stack.Add(High);
+			Stack.Add(Low);
+			continue;
+		}
+
+		if ((Leaves & 63) == 0)
+		{
+			if (Context.IsCancelled()) return false;
+			Context.ReportProgress(Leaves / ExpectedLeaves);
+		}
+		++Leaves;
+		const int32 RoomW = Rand.RandRange(Params.MinRoomSize, FMath::Min(Params.MaxRoomSize, W - 1));
+		const int32 RoomH = Rand.RandRange(Params.MinRoomSize, FMath::Min(Params.MaxRoomSize, H - 1));
+		const int32 X = Rand.RandRange(Leaf.Min.X, Leaf.Max.X - 1 - RoomW);
+		const int32 Y = Rand.RandRange(Leaf.Min.Y, Leaf.Max.Y - 1 - RoomH);
+		Context.TryAddRoom(FIntRect(X, Y, X + RoomW, Y + RoomH));
+	}
+	return true;
+}
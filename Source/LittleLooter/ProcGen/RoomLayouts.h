@@ -0,0 +1,42 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "RoomLayoutStrategy.h"
+#include "PoissonDiskSampler.h"
+
+/** RoomAttempts random rectangles; overlapping ones are dropped. The original layout. */
+class FRejectionRoomLayout : public IRoomLayoutStrategy
+{
+public:
+	virtual const TCHAR* GetName() const override { return TEXT("Rejection"); }
+	virtual bool PlaceRooms(const FProcGenParams& Params, FRandomStream& Rand, const FRoomLayoutContext& Context) override;
+};
+
+/**
+ * Rooms centered on Poisson-disk samples. Every sample lands on free space, so RoomAttempts only
+ * caps the room count. A room that doesn't fit next to its neighbors shrinks toward MinRoomSize.
+ */
+class FPoissonDiskRoomLayout : public IRoomLayoutStrategy
+{
+public:
+	virtual const TCHAR* GetName() const override { return TEXT("PoissonDisk"); }
+	virtual bool PlaceRooms(const FProcGenParams& Params, FRandomStream& Rand, const FRoomLayoutContext& Context) override;
+
+private:
+	FPoissonDiskSampler Sampler;
+};
+
+/**
+ * Binary space partition: the map is split at random positions until every leaf is close to the
+ * largest room size, then each leaf gets one room with a one-tile margin. O(N) in the number of
+ * rooms and nothing is rejected; every leaf is filled, so RoomAttempts is ignored. Leaves come out
+ * depth-first, so consecutive rooms are neighbors.
+ */
+class FBspRoomLayout : public IRoomLayoutStrategy
+{
+public:
+	virtual const TCHAR* GetName() const override { return TEXT("BSP"); }
+	virtual bool PlaceRooms(const FProcGenParams& Params, FRandomStream& Rand, const FRoomLayoutContext& Context) override;
+
+private:
+	TArray<FIntRect> Stack;
+};
@@ -0,0 +1,415 @@
+#include "RoomPortalGraph.h"
+#include "GridPathfinder.h"
+#include "Algo/Reverse.h"
+
+static const FIntPoint Dirs4[] = { FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1) };
+
+void FRoomPortalGraph::Reset()
+{
+	Width = Height = 0;
+	RegionOf.Reset();
+	Regions.Reset();
+	Nodes.Reset();
+	FreeRegions.Reset();
+	FreeNodes.Reset();
+	NodeAt.Reset();
+	CellStamp.Reset();
+	NodeStamp.Reset();
+}
+
+void FRoomPortalGraph::Build(const FMapData& Map)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	Reset();
+	Width = Map.GetWidth();
+	Height = Map.GetHeight();
+	RegionOf.Init(INDEX_NONE, Width * Height);
+	OnCellsChanged(Map, FIntRect(0, 0, Width, Height));
+	BuildSeconds = FPlatformTime::Seconds() - StartSeconds;
+}
+
+void FRoomPortalGraph::OnCellsChanged(const FMapData& Map, const FIntRect& Changed)
+{
+	const FIntRect Rect(FMath::Max(Changed.Min.X - 1, 0), FMath::Max(Changed.Min.Y - 1, 0),
+		FMath::Min(Changed.Max.X + 1, Width), FMath::Min(Changed.Max.Y + 1, Height));
+	if (Rect.Min.X >= Rect.Max.X || Rect.Min.Y >= Rect.Max.Y) return;
+
+	// Regions touching the rect are dissolved; regions on the far side of their portals keep their
+	// cells but need their links redone
+	TSet<int32> Dissolved, Relink;
+	for (int32 y = Rect.Min.Y; y < Rect.Max.Y; ++y)
+		for (int32 x = Rect.Min.X; x < Rect.Max.X; ++x)
+		{
+			const int32 Region = RegionOf[y * Width + x];
+			if (Region != INDEX_NONE) Dissolved.Add(Region);
+		}
+
+	TArray<FIntPoint> Seeds;
+	for (const int32 Region : Dissolved)
+	{
+		FRegion& R = Regions[Region];
+		for (const int32 Node : TArray<int32>(R.Nodes))
+		{
+			for (const FEdge& Edge : Nodes[Node].Edges)
+			{
+				const int32 Other = Nodes[Edge.To].Region;
+				if (!Dissolved.Contains(Other)) Relink.Add(Other);
+			}
+			KillNode(Node);
+		}
+		for (int32 y = R.Bounds.Min.Y; y < R.Bounds.Max.Y; ++y)
+			for (int32 x = R.Bounds.Min.X; x < R.Bounds.Max.X; ++x)
+			{
+				int32& Cell = RegionOf[y * Width + x];
+				if (Cell != Region) continue;
+				Cell = INDEX_NONE;
+				Seeds.Add(FIntPoint(x, y));
+			}
+		R = FRegion();
+		FreeRegions.Add(Region);
+	}
+	for (int32 y = Rect.Min.Y; y < Rect.Max.Y; ++y)
+		for (int32 x = Rect.Min.X; x < Rect.Max.X; ++x)
+		{
+			Seeds.Add(FIntPoint(x, y));
+		}
+
+	TSet<int32> NewRegions;
+	for (const FIntPoint& Seed : Seeds)
+	{
+		if (RegionOf[Seed.Y * Width + Seed.X] == INDEX_NONE && Map.IsWalkable(Seed.X, Seed.Y))
+		{
+			NewRegions.Add(AddRegion(Map, Seed));
+		}
+	}
+
+	for (const int32 Region : NewRegions) AddPortals(Region, NewRegions, Relink);
+
+	// Portal nodes left without a crossing lead nowhere
+	for (const int32 Region : Relink)
+	{
+		for (const int32 Node : TArray<int32>(Regions[Region].Nodes))
+		{
+			bool bCrossing = false;
+			for (const FEdge& Edge : Nodes[Node].Edges) bCrossing |= Nodes[Edge.To].Region != Region;
+			if (!bCrossing) KillNode(Node);
+		}
+	}
+
+	Relink.Append(NewRegions);
+	for (const int32 Region : Relink) LinkRegion(Region);
+}
+
+int32 FRoomPortalGraph::AddRegion(const FMapData& Map, const FIntPoint& Seed)
+{
+	const int32 Region = FreeRegions.Num() > 0 ? FreeRegions.Pop(EAllowShrinking::No) : Regions.AddDefaulted();
+	FRegion& R = Regions[Region];
+	R = FRegion();
+	R.bAlive = true;
+	R.RoomId = Map.GetRoomId(Seed.X, Seed.Y);
+	R.Bounds = FIntRect(Seed, Seed);
+
+	// Flood over walkable cells with the same room id (INDEX_NONE: corridor)
+	Queue.Reset();
+	RegionOf[Seed.Y * Width + Seed.X] = Region;
+	Queue.Add(Seed.Y * Width + Seed.X);
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
+	{
+		const FIntPoint Cell(Queue[Head] % Width, Queue[Head] / Width);
+		for (const FIntPoint& Dir : Dirs4)
+		{
+			const FIntPoint Next = Cell + Dir;
+			if (!Map.IsWalkable(Next.X, Next.Y) || Map.GetRoomId(Next.X, Next.Y) != R.RoomId) continue;
+			int32& NextRegion = RegionOf[Next.Y * Width + Next.X];
+			if (NextRegion != INDEX_NONE) continue;
+			NextRegion = Region;
+			Queue.Add(Next.Y * Width + Next.X);
+			R.Bounds.Include(Next);
+		}
+	}
+	R.Bounds.Max += FIntPoint(1, 1); // Include grows an inclusive max
+	return Region;
+}
+
+int32 FRoomPortalGraph::FindOrAddNode(const FIntPoint& Cell)
+{
+	const int32 CellIndex = Cell.Y * Width + Cell.X;
+	if (const int32* Existing = NodeAt.Find(CellIndex)) return *Existing;
+
+	const int32 Node = FreeNodes.Num() > 0 ? FreeNodes.Pop(EAllowShrinking::No) : Nodes.AddDefaulted();
+	FNode& N = Nodes[Node];
+	N.Cell = Cell;
+	N.Region = RegionOf[CellIndex];
+	N.Edges.Reset();
+	N.bAlive = true;
+	Regions[N.Region].Nodes.Add(Node);
+	NodeAt.Add(CellIndex, Node);
+	return Node;
+}
+
+void FRoomPortalGraph::KillNode(int32 Node)
+{
+	FNode& N = Nodes[Node];
+	for (const FEdge& Edge : N.Edges)
+	{
+		Nodes[Edge.To].Edges.RemoveAllSwap([Node](const FEdge& Back) { return Back.To == Node; });
+	}
+	N.Edges.Reset();
+	N.bAlive = false;
+	Regions[N.Region].Nodes.RemoveSwap(Node);
+	NodeAt.Remove(N.Cell.Y * Width + N.Cell.X);
+	FreeNodes.Add(Node);
+}
+
+void FRoomPortalGraph::AddPortals(int32 Region, const TSet<int32>& NewRegions, TSet<int32>& OutTouched)
+{
+	// Border cells facing another region, keyed so that cells along one straight stretch of border
+	// with the same neighbor sort next to each other
+	struct FBorder
+	{
+		int32 Other;
+		int32 Dir;
+		int32 Line;
+		int32 Along;
+		FIntPoint Cell;
+	};
+	TArray<FBorder> Border;
+	const FIntRect& Bounds = Regions[Region].Bounds;
+	for (int32 y = Bounds.Min.Y; y < Bounds.Max.Y; ++y)
+		for (int32 x = Bounds.Min.X; x < Bounds.Max.X; ++x)
+		{
+			if (RegionOf[y * Width + x] != Region) continue;
+			for (int32 Dir = 0; Dir < 4; ++Dir)
+			{
+				const FIntPoint Next = FIntPoint(x, y) + Dirs4[Dir];
+				const int32 Other = GetRegion(Next);
+				if (Other == INDEX_NONE || Other == Region) continue;
+				// Borders between two new regions are added once, from the lower id
+				if (Other < Region && NewRegions.Contains(Other)) continue;
+				const bool bAlongY = Dir < 2;
+				Border.Add({ Other, Dir, bAlongY ? x : y, bAlongY ? y : x, FIntPoint(x, y) });
+			}
+		}
+
+	Border.Sort([](const FBorder& A, const FBorder& B)
+	{
+		if (A.Other != B.Other) return A.Other < B.Other;
+		if (A.Dir != B.Dir) return A.Dir < B.Dir;
+		if (A.Line != B.Line) return A.Line < B.Line;
+		return A.Along < B.Along;
+	});
+
+	// One portal per stretch, crossing at its middle
+	for (int32 First = 0; First < Border.Num();)
+	{
+		int32 Last = First;
+		while (Last + 1 < Border.Num() && Border[Last + 1].Other == Border[First].Other && Border[Last + 1].Dir == Border[First].Dir
+			&& Border[Last + 1].Line == Border[First].Line && Border[Last + 1].Along == Border[Last].Along + 1)
+		{
+			++Last;
+		}
+		const FBorder& Mid = Border[(First + Last) / 2];
+		const int32 Inside = FindOrAddNode(Mid.Cell);
+		const int32 Outside = FindOrAddNode(Mid.Cell + Dirs4[Mid.Dir]);
+		Nodes[Inside].Edges.Add({ Outside, 1 });
+		Nodes[Outside].Edges.Add({ Inside, 1 });
+		OutTouched.Add(Border[First].Other);
+		First = Last + 1;
+	}
+}
+
+void FRoomPortalGraph::BeginCellSearch() const
+{
+	if (CellStamp.Num() != Width * Height)
+	{
+		CellStamp.Init(0, Width * Height);
+		CellSteps.SetNumUninitialized(Width * Height);
+		CellOwner.SetNumUninitialized(Width * Height);
+		CellSearch = 0;
+	}
+	if (++CellSearch == 0)
+	{
+		FMemory::Memzero(CellStamp.GetData(), CellStamp.Num() * sizeof(uint32));
+		CellSearch = 1;
+	}
+}
+
+template <typename FuncType>
+void FRoomPortalGraph::ForEachReachableNode(int32 Region, const FIntPoint& From, FuncType&& Fn) const
+{
+	BeginCellSearch();
+	Queue.Reset();
+	const int32 Start = From.Y * Width + From.X;
+	CellStamp[Start] = CellSearch;
+	CellSteps[Start] = 0;
+	Queue.Add(Start);
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
+	{
+		const int32 CellIndex = Queue[Head];
+		const FIntPoint Cell(CellIndex % Width, CellIndex / Width);
+		for (const FIntPoint& Dir : Dirs4)
+		{
+			const FIntPoint Next = Cell + Dir;
+			if (GetRegion(Next) != Region) continue;
+			const int32 NextIndex = Next.Y * Width + Next.X;
+			if (CellStamp[NextIndex] == CellSearch) continue;
+			CellStamp[NextIndex] = CellSearch;
+			CellSteps[NextIndex] = CellSteps[CellIndex] + 1;
+			Queue.Add(NextIndex);
+		}
+	}
+
+	for (const int32 Node : Regions[Region].Nodes)
+	{
+		const int32 CellIndex = Nodes[Node].Cell.Y * Width + Nodes[Node].Cell.X;
+		if (CellStamp[CellIndex] == CellSearch) Fn(Node, CellSteps[CellIndex]);
+	}
+}
+
+void FRoomPortalGraph::LinkRegion(int32 Region)
+{
+	for (const int32 Node : Regions[Region].Nodes)
+	{
+		Nodes[Node].Edges.RemoveAllSwap([this, Region](const FEdge& Edge) { return Nodes[Edge.To].Region == Region; });
+	}
+	if (Regions[Region].Nodes.Num() > MaxAllPairsNodes)
+	{
+		LinkRegionFronts(Region);
+		return;
+	}
+	for (const int32 Node : Regions[Region].Nodes)
+	{
+		ForEachReachableNode(Region, Nodes[Node].Cell, [this, Node](int32 Other, int32 Steps)
+		{
+			if (Other != Node) Nodes[Node].Edges.Add({ Other, Steps });
+		});
+	}
+}
+
+void FRoomPortalGraph::LinkRegionFronts(int32 Region)
+{
+	// One BFS grown from every node at once: each cell goes to the node that reaches it first, and
+	// two nodes are linked where their fronts touch, at the shortest meeting found. Their link cost
+	// is a real in-region walk, so it never underestimates; nodes whose fronts never touch get there
+	// through the ones in between. A connected region keeps a connected set of links.
+	BeginCellSearch();
+	Queue.Reset();
+	for (const int32 Node : Regions[Region].Nodes)
+	{
+		const int32 CellIndex = Nodes[Node].Cell.Y * Width + Nodes[Node].Cell.X;
+		CellStamp[CellIndex] = CellSearch;
+		CellSteps[CellIndex] = 0;
+		CellOwner[CellIndex] = Node;
+		Queue.Add(CellIndex);
+	}
+
+	TMap<uint64, int32> Links; // (lower node, higher node) -> best meeting cost
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
+	{
+		const int32 CellIndex = Queue[Head];
+		const FIntPoint Cell(CellIndex % Width, CellIndex / Width);
+		for (const FIntPoint& Dir : Dirs4)
+		{
+			const FIntPoint Next = Cell + Dir;
+			if (GetRegion(Next) != Region) continue;
+			const int32 NextIndex = Next.Y * Width + Next.X;
+			if (CellStamp[NextIndex] != CellSearch)
+			{
+				CellStamp[NextIndex] = CellSearch;
+				CellSteps[NextIndex] = CellSteps[CellIndex] + 1;
+				CellOwner[NextIndex] = CellOwner[CellIndex];
+				Queue.Add(NextIndex);
+				continue;
+			}
+
+			const int32 A = CellOwner[CellIndex];
+			const int32 B = CellOwner[NextIndex];
+			if (A == B) continue;
+			const int32 Cost = CellSteps[CellIndex] + 1 + CellSteps[NextIndex];
+			int32& Best = Links.FindOrAdd((uint64(FMath::Min(A, B)) << 32) | uint32(FMath::Max(A, B)), MAX_int32);
+			Best = FMath::Min(Best, Cost);
+		}
+	}
+
+	for (const TPair<uint64, int32>& Link : Links)
+	{
+		const int32 A = int32(Link.Key >> 32);
+		const int32 B = int32(Link.Key & 0xFFFFFFFF);
+		Nodes[A].Edges.Add({ B, Link.Value });
+		Nodes[B].Edges.Add({ A, Link.Value });
+	}
+}
+
+bool FRoomPortalGraph::FindPath(const FGridPathfinder& Cells, const FIntPoint& Start, const FIntPoint& Goal, TArray<FIntPoint>& OutFirstLeg, TArray<FIntPoint>& OutWaypoints) const
+{
+	OutFirstLeg.Reset();
+	OutWaypoints.Reset();
+	const int32 StartRegion = GetRegion(Start);
+	const int32 GoalRegion = GetRegion(Goal);
+	if (StartRegion == INDEX_NONE || GoalRegion == INDEX_NONE) return false;
+
+	if (StartRegion == GoalRegion)
+	{
+		if (!Cells.FindPath(Start, Goal, OutFirstLeg)) return false;
+		OutWaypoints.Add(Goal);
+		return true;
+	}
+
+	if (NodeStamp.Num() != Nodes.Num())
+	{
+		NodeStamp.Init(0, Nodes.Num());
+		NodeG.SetNumUninitialized(Nodes.Num());
+		NodeParent.SetNumUninitialized(Nodes.Num());
+		GoalSteps.SetNumUninitialized(Nodes.Num());
+		NodeSearch = 0;
+	}
+	if (++NodeSearch == 0)
+	{
+		FMemory::Memzero(NodeStamp.GetData(), NodeStamp.Num() * sizeof(uint32));
+		NodeSearch = 1;
+	}
+
+	// Goal region nodes learn their distance to Goal; a goal-region node is the end once popped
+	for (const int32 Node : Regions[GoalRegion].Nodes) GoalSteps[Node] = INDEX_NONE;
+	ForEachReachableNode(GoalRegion, Goal, [this](int32 Node, int32 Steps) { GoalSteps[Node] = Steps; });
+
+	const auto Heuristic = [this, &Goal](int32 Node) { return FMath::Abs(Nodes[Node].Cell.X - Goal.X) + FMath::Abs(Nodes[Node].Cell.Y - Goal.Y); };
+	const auto Push = [this, &Heuristic](int32 Node, int32 G, int32 Parent)
+	{
+		if (NodeStamp[Node] == NodeSearch && G >= NodeG[Node]) return;
+		NodeStamp[Node] = NodeSearch;
+		NodeG[Node] = G;
+		NodeParent[Node] = Parent;
+		Open.HeapPush({ G + Heuristic(Node), G, Node });
+	};
+
+	Open.Reset();
+	ForEachReachableNode(StartRegion, Start, [&Push](int32 Node, int32 Steps) { Push(Node, Steps, INDEX_NONE); });
+
+	// Goal isn't a node; every goal-region node popped offers a complete path through it. Manhattan
+	// never overestimates, so once nothing open can beat the best complete path we're done.
+	int32 BestEnd = INDEX_NONE;
+	int32 BestEndCost = MAX_int32;
+	while (Open.Num() > 0)
+	{
+		FOpenNode Top;
+		Open.HeapPop(Top, EAllowShrinking::No);
+		if (Top.F >= BestEndCost) break;
+		if (Top.G > NodeG[Top.Node]) continue; // superseded
+
+		const FNode& N = Nodes[Top.Node];
+		if (N.Region == GoalRegion && GoalSteps[Top.Node] != INDEX_NONE && Top.G + GoalSteps[Top.Node] < BestEndCost)
+		{
+			BestEnd = Top.Node;
+			BestEndCost = Top.G + GoalSteps[Top.Node];
+		}
+		for (const FEdge& Edge : N.Edges) Push(Edge.To, Top.G + Edge.Cost, Top.Node);
+	}
+	if (BestEnd == INDEX_NONE) return false;
+
+	for (int32 Node = BestEnd; Node != INDEX_NONE; Node = NodeParent[Node]) OutWaypoints.Add(Nodes[Node].Cell);
+	Algo::Reverse(OutWaypoints);
+	OutWaypoints.Add(Goal);
+
+	return Cells.FindPath(Start, OutWaypoints[0], OutFirstLeg);
+}
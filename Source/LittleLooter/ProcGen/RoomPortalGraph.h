@@ -0,0 +1,117 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ProcTypes.h"
+
+struct FGridPathfinder;
+
+/**
+ * Abstract graph for long queries (HPA*). Walkable cells are split into regions: one per room
+ * (cells with that RoomId) and one per connected run of corridor cells (RoomId INDEX_NONE).
+ * Each stretch of border between two regions becomes a portal: a pair of nodes, one cell on each
+ * side. Nodes within a region are linked by their in-region BFS distance: all pairs in regions with
+ * few portals, otherwise only nodes whose BFS fronts meet (see LinkRegion), which keeps linking one
+ * region O(cells) and its edges O(portals).
+ *
+ * A query searches this graph and only refines the first leg at cell level, so its cost tracks
+ * the number of rooms and corridors crossed rather than the cells in between. Not thread-safe.
+ */
+struct FRoomPortalGraph
+{
+	struct FEdge
+	{
+		int32 To;
+		int32 Cost;
+	};
+
+	struct FNode
+	{
+		FIntPoint Cell;
+		int32 Region = INDEX_NONE;
+		TArray<FEdge> Edges; // portal crossings (cost 1) and in-region links
+		bool bAlive = false;
+	};
+
+	struct FRegion
+	{
+		int32 RoomId = INDEX_NONE; // INDEX_NONE for corridor regions
+		FIntRect Bounds;
+		TArray<int32> Nodes;
+		bool bAlive = false;
+	};
+
+	void Reset();
+
+	/** Builds regions, portals and in-region links for the whole map. */
+	void Build(const FMapData& Map);
+
+	/**
+	 * Call after cells in Changed (and walls around them) were edited. Only regions touching Changed
+	 * or one of its neighbors are relabeled; regions across their portals just get their links redone.
+	 */
+	void OnCellsChanged(const FMapData& Map, const FIntRect& Changed);
+
+	/**
+	 * Hierarchical path from Start to Goal. OutWaypoints are the portal cells to pass through, ending
+	 * with Goal; OutFirstLeg is the exact cell path (Start included) to the first waypoint, found with
+	 * Cells. Start and Goal in one region get the full exact path as the first leg.
+	 */
+	bool FindPath(const FGridPathfinder& Cells, const FIntPoint& Start, const FIntPoint& Goal, TArray<FIntPoint>& OutFirstLeg, TArray<FIntPoint>& OutWaypoints) const;
+
+	FORCEINLINE int32 GetRegion(const FIntPoint& Cell) const
+	{
+		return (Cell.X >= 0 && Cell.Y >= 0 && Cell.X < Width && Cell.Y < Height) ? RegionOf[Cell.Y * Width + Cell.X] : INDEX_NONE;
+	}
+
+	int32 NumRegions() const { return Regions.Num() - FreeRegions.Num(); }
+	int32 NumNodes() const { return Nodes.Num() - FreeNodes.Num(); }
+	double GetBuildSeconds() const { return BuildSeconds; }
+
+	/** Regions with more portal nodes than this are linked through one shared BFS instead of one BFS per node. */
+	static constexpr int32 MaxAllPairsNodes = 8;
+
+private:
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<int32> RegionOf; // row-major, INDEX_NONE for non-walkable cells
+	TArray<FRegion> Regions;
+	TArray<FNode> Nodes;
+	TArray<int32> FreeRegions;
+	TArray<int32> FreeNodes;
+	TMap<int32, int32> NodeAt; // cell index -> node
+	double BuildSeconds = 0.0;
+
+	int32 AddRegion(const FMapData& Map, const FIntPoint& Seed);
+	int32 FindOrAddNode(const FIntPoint& Cell);
+	void KillNode(int32 Node);
+	void AddPortals(int32 Region, const TSet<int32>& NewRegions, TSet<int32>& OutTouched);
+	void LinkRegion(int32 Region);
+	void LinkRegionFronts(int32 Region);
+
+	/** Next cell stamp for a region BFS; sizes the scratch on first use. */
+	void BeginCellSearch() const;
+
+	/** BFS from From inside its region; calls Fn(Node, Steps) for every node of the region reached. */
+	template <typename FuncType>
+	void ForEachReachableNode(int32 Region, const FIntPoint& From, FuncType&& Fn) const;
+
+	// Scratch for region BFS and the abstract search, valid where the stamp matches
+	mutable TArray<uint32> CellStamp;
+	mutable TArray<int32> CellSteps;
+	mutable TArray<int32> CellOwner; // LinkRegionFronts: node whose front reached the cell first
+	mutable TArray<int32> Queue;
+	mutable uint32 CellSearch = 0;
+
+	struct FOpenNode
+	{
+		int32 F;
+		int32 G;
+		int32 Node;
+		bool operator<(const FOpenNode& Other) const { return F < Other.F; }
+	};
+	mutable TArray<uint32> NodeStamp;
+	mutable TArray<int32> NodeG;
+	mutable TArray<int32> NodeParent;
+	mutable TArray<int32> GoalSteps; // per node of the goal region, steps on to Goal
+	mutable TArray<FOpenNode> Open;
+	mutable uint32 NodeSearch = 0;
+};
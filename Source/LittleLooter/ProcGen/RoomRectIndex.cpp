@@ -0,0 +1,68 @@
+#include "RoomRectIndex.h"
+
+void FRoomRectIndex::Init(int32 InWidth, int32 InHeight, int32 InBucketSize)
+{
+	Width = FMath::Max(InWidth, 0);
+	Height = FMath::Max(InHeight, 0);
+	BucketSize = FMath::Max(InBucketSize, 1);
+	BucketsX = FMath::Max(FMath::DivideAndRoundUp(Width, BucketSize), 1);
+	BucketsY = FMath::Max(FMath::DivideAndRoundUp(Height, BucketSize), 1);
+
+	Rects.Reset();
+	LastQuery.Reset();
+	QueryStamp = 0;
+
+	Buckets.SetNum(BucketsX * BucketsY, EAllowShrinking::No);
+	for (TArray<int32>& Bucket : Buckets) Bucket.Reset();
+}
+
+void FRoomRectIndex::Add(const FIntRect& Rect)
+{
+	// Only in-map cells are ever occupied, so store what actually got stamped
+	const FIntRect Clipped(FMath::Max(Rect.Min.X, 0), FMath::Max(Rect.Min.Y, 0),
+		FMath::Min(Rect.Max.X, Width), FMath::Min(Rect.Max.Y, Height));
+	if (Clipped.Min.X >= Clipped.Max.X || Clipped.Min.Y >= Clipped.Max.Y) return;
+
+	const int32 Id = Rects.Add(Clipped);
+	LastQuery.Add(0);
+
+	const int32 BX0 = BucketCoord(Clipped.Min.X, BucketsX), BX1 = BucketCoord(Clipped.Max.X - 1, BucketsX);
+	const int32 BY0 = BucketCoord(Clipped.Min.Y, BucketsY), BY1 = BucketCoord(Clipped.Max.Y - 1, BucketsY);
+	for (int32 by = BY0; by <= BY1; ++by)
+		for (int32 bx = BX0; bx <= BX1; ++bx)
+		{
+			Buckets[by * BucketsX + bx].Add(Id);
+		}
+}
+
+bool FRoomRectIndex::Overlaps(const FIntRect& Rect) const
+{
+	if (Rects.Num() == 0) return false;
+	if (Rect.Max.X <= 0 || Rect.Max.Y <= 0 || Rect.Min.X >= Width || Rect.Min.Y >= Height) return false;
+
+	if (++QueryStamp == 0)
+	{
+		// Wrapped; forget every stale stamp
+		FMemory::Memzero(LastQuery.GetData(), LastQuery.Num() * sizeof(uint32));
+		QueryStamp = 1;
+	}
+
+	const int32 BX0 = BucketCoord(Rect.Min.X, BucketsX), BX1 = BucketCoord(Rect.Max.X - 1, BucketsX);
+	const int32 BY0 = BucketCoord(Rect.Min.Y, BucketsY), BY1 = BucketCoord(Rect.Max.Y - 1, BucketsY);
+	for (int32 by = BY0; by <= BY1; ++by)
+		for (int32 bx = BX0; bx <= BX1; ++bx)
+		{
+			for (const int32 Id : Buckets[by * BucketsX + bx])
+			{
+				if (LastQuery[Id] == QueryStamp) continue;
+				LastQuery[Id] = QueryStamp;
+
+				const FIntRect& R = Rects[Id];
+				if (Rect.Min.X < R.Max.X && R.Min.X < Rect.Max.X && Rect.Min.Y < R.Max.Y && R.Min.Y < Rect.Max.Y)
+				{
+					return true;
+				}
+			}
+		}
+	return false;
+}
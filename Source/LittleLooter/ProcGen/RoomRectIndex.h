@@ -0,0 +1,37 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Uniform-bucket spatial index of placed room rectangles.
+ * Overlap queries only look at rooms registered in the buckets the query touches,
+ * so the cost is O(k) in nearby rooms instead of O(area) cell probes.
+ */
+struct FRoomRectIndex
+{
+	/** Sizes the bucket grid for a Width x Height map. Keeps allocations from a previous Init. */
+	void Init(int32 InWidth, int32 InHeight, int32 InBucketSize = 16);
+
+	/** Registers a room. Rect is [Min, Max) and is clipped to the map. */
+	void Add(const FIntRect& Rect);
+
+	/** True if Rect shares at least one cell with a registered room. */
+	bool Overlaps(const FIntRect& Rect) const;
+
+	int32 Num() const { return Rects.Num(); }
+
+private:
+	FORCEINLINE int32 BucketCoord(int32 V, int32 NumBuckets) const { return FMath::Clamp(V / BucketSize, 0, NumBuckets - 1); }
+
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 BucketSize = 16;
+	int32 BucketsX = 0;
+	int32 BucketsY = 0;
+
+	TArray<FIntRect> Rects;
+	TArray<TArray<int32>> Buckets; // row-major, room indices per bucket
+
+	// A room spanning several buckets is tested once per query
+	mutable TArray<uint32> LastQuery;
+	mutable uint32 QueryStamp = 0;
+};
@@ -0,0 +1,123 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ProcGen/MapGenerator.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace ProcMapBenchmarkTest
+{
+	struct FTier
+	{
+		int32 Width;
+		int32 Height;
+		int32 Iterations; // fewer on big maps so the whole suite stays in minutes
+	};
+	const FTier Tiers[] = { { 80, 60, 50 }, { 256, 256, 20 }, { 1024, 1024, 6 }, { 4096, 4096, 3 } };
+	const int32 RoomAttemptSettings[] = { 80, 400, 2000 };
+
+	/** Nearest-rank percentile of an ascending array. */
+	double Percentile(const TArray<double>& Sorted, double P)
+	{
+		const int32 Rank = FMath::Clamp(FMath::CeilToInt(P * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Rank];
+	}
+
+	FString GetCsvPath()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("ProcGenBenchmark.csv");
+	}
+}
+
+/**
+ * Times UMapGenerator::Run and its stages per size tier and RoomAttempts setting. Each tier/setting
+ * is its own test so it can be run alone, e.g. -runtests="LittleLooter.ProcGen.Benchmark.1024x1024".
+ * Rows are appended to Saved/Benchmarks/ProcGenBenchmark.csv, one per stage.
+ */
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FProcMapBenchmarkTest, "LittleLooter.ProcGen.Benchmark",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FProcMapBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	using namespace ProcMapBenchmarkTest;
+	for (const FTier& Tier : Tiers)
+	{
+		for (int32 RoomAttempts : RoomAttemptSettings)
+		{
+			OutBeautifiedNames.Add(FString::Printf(TEXT("%dx%d.Attempts%d"), Tier.Width, Tier.Height, RoomAttempts));
+			OutTestCommands.Add(FString::Printf(TEXT("%d %d %d %d"), Tier.Width, Tier.Height, RoomAttempts, Tier.Iterations));
+		}
+	}
+}
+
+bool FProcMapBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace ProcMapBenchmarkTest;
+	TArray<FString> Args;
+	Parameters.ParseIntoArrayWS(Args);
+	if (!TestEqual(TEXT("test command arguments"), Args.Num(), 4)) return false;
+
+	FProcGenParams Params;
+	Params.Width = FCString::Atoi(*Args[0]);
+	Params.Height = FCString::Atoi(*Args[1]);
+	Params.RoomAttempts = FCString::Atoi(*Args[2]);
+	const int32 Iterations = FCString::Atoi(*Args[3]);
+
+	TStrongObjectPtr<UMapGenerator> Generator(NewObject<UMapGenerator>());
+	FMapData Map;
+
+	// One untimed run warms the generator's scratch buffers and the map's allocations, like a level regenerating
+	Generator->Run(Params, 0, Map);
+
+	enum EStage { Total, Rooms, Corridors, Validation, Walls, NumStages };
+	const TCHAR* StageNames[NumStages] = { TEXT("Run"), TEXT("Rooms"), TEXT("Corridors"), TEXT("Validation"), TEXT("Walls") };
+	TArray<double> Ms[NumStages];
+	int64 RoomsTotal = 0;
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		const double Start = FPlatformTime::Seconds();
+		Generator->Run(Params, i + 1, Map);
+		Ms[Total].Add((FPlatformTime::Seconds() - Start) * 1000.0);
+		Ms[Rooms].Add(Map.Stats.RoomsSeconds * 1000.0);
+		Ms[Corridors].Add(Map.Stats.CorridorsSeconds * 1000.0);
+		Ms[Validation].Add(Map.Stats.ValidationSeconds * 1000.0);
+		Ms[Walls].Add(Map.Stats.WallsSeconds * 1000.0);
+		RoomsTotal += Map.Rooms.Num();
+	}
+
+	// Allocation counts aren't exposed by the allocators outside of memory tracing, so memory is reported
+	// as the map's own footprint and the process high-water mark
+	const FPlatformMemoryStats Memory = FPlatformMemory::GetStats();
+	const double MapMB = Map.GetAllocatedSize() / (1024.0 * 1024.0);
+	const double PeakMB = Memory.PeakUsedPhysical / (1024.0 * 1024.0);
+
+	const FString CsvPath = GetCsvPath();
+	FString Csv;
+	if (!FPaths::FileExists(CsvPath))
+	{
+		Csv += TEXT("Timestamp,Build,Width,Height,RoomAttempts,Iterations,AvgRooms,Stage,MedianMs,P95Ms,MinMs,MapMB,PeakUsedPhysicalMB\n");
+	}
+	const FString Timestamp = FDateTime::Now().ToString(TEXT("%Y-%m-%d %H:%M:%S"));
+	for (int32 Stage = 0; Stage < NumStages; ++Stage)
+	{
+		Ms[Stage].Sort();
+		const double Median = Percentile(Ms[Stage], 0.5), P95 = Percentile(Ms[Stage], 0.95);
+		Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%d,%.1f,%s,%.3f,%.3f,%.3f,%.2f,%.1f\n"),
+			*Timestamp, LexToString(FApp::GetBuildConfiguration()), Params.Width, Params.Height, Params.RoomAttempts, Iterations,
+			double(RoomsTotal) / Iterations, StageNames[Stage], Median, P95, Ms[Stage][0], MapMB, PeakMB);
+		AddInfo(FString::Printf(TEXT("%s: median %.3f ms, p95 %.3f ms"), StageNames[Stage], Median, P95));
+	}
+	AddInfo(FString::Printf(TEXT("%.1f rooms on average, map %.2f MB, process peak %.1f MB"), double(RoomsTotal) / Iterations, MapMB, PeakMB));
+
+	TestTrue(*FString::Printf(TEXT("write %s"), *CsvPath),
+		FFileHelper::SaveStringToFile(Csv, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,161 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ProcGen/MapGenerator.h"
+#include "ProcGen/ProcInstanceBuilder.h"
+#include "ProcGen/ProcMapFile.h"
+#include "ProcGen/ProcMapFingerprint.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Tasks/Task.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace ProcMapDeterminismTest
+{
+	struct FCase
+	{
+		FString Name;
+		FProcGenParams Params;
+		int32 Seed = 0;
+	};
+
+	/** Seeds crossed with param sets that cover every layout, storage, connectivity and validation path. */
+	TArray<FCase> MakeCorpus()
+	{
+		TArray<TPair<FString, FProcGenParams>> Variants;
+		FProcGenParams Base;
+		Base.Width = 96;
+		Base.Height = 96;
+		Variants.Emplace(TEXT("Rejection"), Base);
+		{
+			FProcGenParams P = Base;
+			P.Layout = ERoomLayout::PoissonDisk;
+			P.Storage = EMapStorage::Chunked;
+			Variants.Emplace(TEXT("PoissonChunked"), P);
+		}
+		{
+			FProcGenParams P = Base;
+			P.Layout = ERoomLayout::Bsp;
+			P.Connectivity = ERoomConnectivity::MinimumSpanningTree;
+			P.CorridorMode = ECorridorMode::AStar;
+			Variants.Emplace(TEXT("BspMstAStar"), P);
+		}
+		{
+			FProcGenParams P = Base;
+			P.Width = P.Height = 200;
+			P.RoomAttempts = 400;
+			P.bParallelChunks = true;
+			P.Connectivity = ERoomConnectivity::MinimumSpanningTree;
+			Variants.Emplace(TEXT("ParallelChunks"), P);
+		}
+		{
+			FProcGenParams P = Base;
+			P.Validation = EMapValidation::Repair;
+			P.MinReachablePercent = 100.f;
+			Variants.Emplace(TEXT("Repair"), P);
+		}
+		{
+			FProcGenParams P = Base;
+			P.Validation = EMapValidation::Reject;
+			P.MinReachablePercent = 100.f;
+			Variants.Emplace(TEXT("Reject"), P);
+		}
+
+		TArray<FCase> Corpus;
+		for (const TPair<FString, FProcGenParams>& Variant : Variants)
+		{
+			for (int32 Seed : { 1, 7, 42, 1337, 9001, -5, 123456789, 31337 })
+			{
+				Corpus.Add({ FString::Printf(TEXT("%s/%d"), *Variant.Key, Seed), Variant.Value, Seed });
+			}
+		}
+		return Corpus;
+	}
+
+	FProcMapFingerprint Generate(UMapGenerator& Generator, const FCase& Case, FMapData& Map, FProcInstanceBatch& Instances)
+	{
+		Generator.Run(Case.Params, Case.Seed, Map);
+		Instances.Reset();
+		FProcInstanceBuilder::Build(Map, FProcInstanceSettings(), Instances);
+		return FProcMapFingerprint::Make(Map, Instances);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProcMapDeterminismTest, "LittleLooter.ProcGen.Determinism",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FProcMapDeterminismTest::RunTest(const FString& Parameters)
+{
+	using namespace ProcMapDeterminismTest;
+	const TArray<FCase> Corpus = MakeCorpus();
+
+	// Golden values: one generator, one map at a time
+	TArray<FProcMapFingerprint> Golden;
+	{
+		TStrongObjectPtr<UMapGenerator> Generator(NewObject<UMapGenerator>());
+		FMapData Map;
+		FProcInstanceBatch Instances;
+		for (const FCase& Case : Corpus)
+		{
+			Golden.Add(Generate(*Generator, Case, Map, Instances));
+
+			// Same generator again, now with warm scratch buffers
+			TestEqual(*FString::Printf(TEXT("%s rerun"), *Case.Name), Generate(*Generator, Case, Map, Instances).GetCombined(), Golden.Last().GetCombined());
+
+			// Storage round trips must not change the map either
+			FMapData Copy;
+			TArray<uint8> Bytes;
+			FMemoryWriter Writer(Bytes);
+			Map.Serialize(Writer);
+			FMemoryReader Reader(Bytes);
+			Copy.Serialize(Reader);
+			TestEqual(*FString::Printf(TEXT("%s cache round trip"), *Case.Name), FProcMapFingerprint::Make(Copy).GetCombined(), FProcMapFingerprint::Make(Map).GetCombined());
+
+			FProcMapFile::Write(Map, Case.Seed, 0, Bytes);
+			FProcMapFileView View;
+			const bool bRead = View.OpenMemory(Bytes.GetData(), Bytes.Num()) && FProcMapFile::Read(View, Copy);
+			TestTrue(*FString::Printf(TEXT("%s baked file reads"), *Case.Name), bRead);
+			if (bRead)
+			{
+				TestEqual(*FString::Printf(TEXT("%s baked round trip"), *Case.Name), FProcMapFingerprint::Make(Copy).GetCombined(), FProcMapFingerprint::Make(Map).GetCombined());
+			}
+		}
+	}
+
+	// Concurrent: N workers, each with its own generator, interleaved over the corpus in a different order
+	const int32 NumWorkers = FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads(), 2, 8);
+	TArray<TStrongObjectPtr<UMapGenerator>> Generators;
+	for (int32 w = 0; w < NumWorkers; ++w) Generators.Emplace(NewObject<UMapGenerator>());
+
+	TArray<FProcMapFingerprint> Results;
+	Results.SetNum(Corpus.Num());
+	TArray<UE::Tasks::FTask> Tasks;
+	for (int32 w = 0; w < NumWorkers; ++w)
+	{
+		Tasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Corpus, &Results, &Generators, w, NumWorkers]()
+		{
+			FMapData Map;
+			FProcInstanceBatch Instances;
+			for (int32 i = Corpus.Num() - 1 - w; i >= 0; i -= NumWorkers)
+			{
+				Results[i] = Generate(*Generators[w], Corpus[i], Map, Instances);
+			}
+		}));
+	}
+	UE::Tasks::Wait(Tasks);
+
+	for (int32 i = 0; i < Corpus.Num(); ++i)
+	{
+		if (Results[i] != Golden[i])
+		{
+			AddError(FString::Printf(TEXT("%s differs on %d workers: %s, serial %s"),
+				*Corpus[i].Name, NumWorkers, *Results[i].ToString(), *Golden[i].ToString()));
+		}
+	}
+	AddInfo(FString::Printf(TEXT("%d maps checked on %d workers"), Corpus.Num(), NumWorkers));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
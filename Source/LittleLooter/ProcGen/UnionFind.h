@@ -0,0 +1,52 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Disjoint sets over 0..N-1 with union by size and path halving. */
+struct FUnionFind
+{
+	void Init(int32 Num)
+	{
+		Parent.SetNumUninitialized(Num, EAllowShrinking::No);
+		Size.SetNumUninitialized(Num, EAllowShrinking::No);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			Parent[i] = i;
+			Size[i] = 1;
+		}
+		NumSets = Num;
+	}
+
+	FORCEINLINE int32 Find(int32 X)
+	{
+		while (Parent[X] != X)
+		{
+			Parent[X] = Parent[Parent[X]];
+			X = Parent[X];
+		}
+		return X;
+	}
+
+	/** Joins the sets of A and B. False if they were already one set. */
+	FORCEINLINE bool Union(int32 A, int32 B)
+	{
+		A = Find(A);
+		B = Find(B);
+		if (A == B) return false;
+		if (Size[A] < Size[B]) Swap(A, B);
+		Parent[B] = A;
+		Size[A] += Size[B];
+		--NumSets;
+		return true;
+	}
+
+	/** Elements in X's set. */
+	FORCEINLINE int32 SetSize(int32 X) { return Size[Find(X)]; }
+
+	int32 Num() const { return Parent.Num(); }
+	int32 GetNumSets() const { return NumSets; }
+
+private:
+	TArray<int32> Parent;
+	TArray<int32> Size;
+	int32 NumSets = 0;
+};